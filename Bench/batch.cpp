@@ -0,0 +1,71 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <chrono>
+
+using namespace std;
+
+// n same sized nodes at once, mem_alloc_batch/mem_free_batch against n single calls
+class Batch {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 64*1024*1024,
+                                        NODE_SIZE       = 48,
+                                        OBJ_AMNT        = 4'000'000;
+
+        template<typename A>
+        double run_single(A &mem, void **v, const size_t n) const {
+            const auto start = chrono::steady_clock::now();
+
+            for(size_t r = 0; r < OBJ_AMNT / n; r++) {
+                for(size_t i = 0; i < n; i++)
+                    v[i] = mem.mem_alloc(NODE_SIZE);
+
+                for(size_t i = 0; i < n; i++)
+                    mem.mem_free(v[i]);
+            }
+
+            return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / (n * (OBJ_AMNT / n));
+        }
+
+        template<typename A>
+        double run_batch(A &mem, void **v, const size_t n) const {
+            const auto start = chrono::steady_clock::now();
+
+            for(size_t r = 0; r < OBJ_AMNT / n; r++) {
+                mem.mem_alloc_batch(NODE_SIZE, n, v);
+                mem.mem_free_batch(v, n);
+            }
+
+            return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / (n * (OBJ_AMNT / n));
+        }
+
+        template<typename A>
+        void run_alloc(const char *name) {
+            vector<void*> v(4096);
+
+            for(size_t n = 16; n <= 4096; n *= 4) {
+                A *single = new A(),
+                  *batch = new A();
+
+                // warm up so both start with the same free lists
+                run_single(*single, v.data(), n);
+                run_batch(*batch, v.data(), n);
+
+                printf("%-10s %6zu %12.2f %12.2f\n", name, n, run_single(*single, v.data(), n), run_batch(*batch, v.data(), n));
+
+                delete single;
+                delete batch;
+            }
+        }
+
+    public:
+        void run() {
+            cout << "--- batch alloc + free of " << NODE_SIZE << "b nodes (ns per node) ---" << endl;
+            printf("%-10s %6s %12s %12s\n", "", "n", "single", "batch");
+
+            run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST");
+            run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE");
+        }
+};
@@ -0,0 +1,50 @@
+#include <iostream> 
+#include "threadScaling.cpp"
+#include "tailLatency.cpp"
+#include "freeLatency.cpp"
+#include "fragmentation.cpp"
+#include "slabDensity.cpp"
+#include "batch.cpp"
+#include "pageModes.cpp"
+#include "containers.cpp"
+#include "workloads.cpp"
+#include "requestArena.cpp"
+#include "pool.cpp"
+#include "trim.cpp"
+#include "sharedIpc.cpp"
+
+using namespace std; 
+
+class Benchmarks {
+    private: 
+        ThreadScaling ts; 
+        TailLatency tl; 
+        FreeLatency fl; 
+        Fragmentation fr; 
+        SlabDensity sd; 
+        Batch ba; 
+        PageModes pm; 
+        Containers co; 
+        Workloads wl; 
+        RequestArena ra; 
+        Pool po; 
+        Trim tr; 
+        SharedIpc si; 
+
+    public: 
+        void run_benchmarks() {
+            ts.run(); 
+            tl.run(); 
+            fl.run(); 
+            fr.run(); 
+            sd.run(); 
+            ba.run(); 
+            pm.run(); 
+            co.run(); 
+            wl.run(); 
+            ra.run(); 
+            po.run(); 
+            tr.run(); 
+            si.run(); 
+        }
+}; 
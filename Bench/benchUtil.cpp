@@ -0,0 +1,85 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#endif
+
+using namespace std;
+
+// cycle counter for timing single operations, falls back to ns where there is no tsc
+static inline uint64_t cycles() {
+    #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    #endif
+}
+
+// per op timings, sorted once when the first percentile is asked for
+class Samples {
+    private:
+        vector<uint64_t> v;
+        bool sorted = false;
+
+    public:
+        Samples(const size_t reserve = 0) { v.reserve(reserve); }
+
+        inline void add(const uint64_t c) {
+            v.push_back(c);
+            sorted = false;
+        }
+
+        uint64_t percentile(const double p) {
+            if(v.empty())
+                return 0;
+
+            if(!sorted) {
+                sort(v.begin(), v.end());
+                sorted = true;
+            }
+
+            return v[(size_t)(p / 100.0 * (v.size() - 1))];
+        }
+
+        inline uint64_t max() { return percentile(100); }
+        inline size_t size() const { return v.size(); }
+};
+
+// resident set size of the whole process right now
+static inline size_t rss_bytes() {
+    FILE *f = fopen("/proc/self/statm", "r");
+    size_t pages = 0, resident = 0;
+
+    if(f) {
+        if(fscanf(f, "%zu %zu", &pages, &resident) != 2)
+            resident = 0;
+
+        fclose(f);
+    }
+
+    return resident * 4096;
+}
+
+// highest resident set size the process had so far (VmHWM)
+static inline size_t peak_rss_bytes() {
+    FILE *f = fopen("/proc/self/status", "r");
+    char line[256];
+    size_t kb = 0;
+
+    if(f) {
+        while(fgets(line, sizeof(line), f))
+            if(sscanf(line, "VmHWM: %zu kB", &kb) == 1)
+                break;
+
+        fclose(f);
+    }
+
+    return kb * 1024;
+}
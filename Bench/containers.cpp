@@ -0,0 +1,117 @@
+#include <iostream>
+#include "../memResource.h"
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <random>
+#include <chrono>
+
+using namespace std;
+
+// node based containers on the default allocator against FAST and PRECISE through the adapters
+class Containers {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 512*1024*1024;
+
+        static constexpr    int         NODE_AMNT       = 1'000'000,
+                                        ROUNDS          = 3;
+
+        using Fast      = MemAllocator<FAST, MEM_SIZE>;
+        using Precise   = MemAllocator<PRECISE, MEM_SIZE>;
+
+        template<typename T, typename A>
+        using Alloc = MemStlAllocator<T, A>;
+
+        // fill, erase every second node, then the rest from the front
+        template<typename L>
+        double run_list(L &l) {
+            const auto start = chrono::steady_clock::now();
+
+            for(int r = 0; r < ROUNDS; r++) {
+                for(int i = 0; i < NODE_AMNT; i++)
+                    l.push_back(i);
+
+                for(auto it = l.begin(); it != l.end();) {
+                    it = l.erase(it);
+
+                    if(it != l.end())
+                        ++it;
+                }
+
+                while(!l.empty())
+                    l.pop_front();
+            }
+
+            return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / (ROUNDS * NODE_AMNT * 2.0);
+        }
+
+        // random keys in, random keys out
+        template<typename M>
+        double run_map(M &m) {
+            mt19937 gen(42);
+            const auto start = chrono::steady_clock::now();
+
+            for(int r = 0; r < ROUNDS; r++) {
+                for(int i = 0; i < NODE_AMNT; i++)
+                    m[gen()] = i;
+
+                while(!m.empty())
+                    m.erase(m.begin());
+            }
+
+            return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / (ROUNDS * NODE_AMNT * 2.0);
+        }
+
+        template<typename A>
+        void run_heap(const char *name) {
+            A *mem = new A();
+
+            {
+                list<int, Alloc<int, A>> l((Alloc<int, A>(*mem)));
+                map<uint32_t, int, less<uint32_t>, Alloc<pair<const uint32_t, int>, A>> m((Alloc<int, A>(*mem)));
+                unordered_map<uint32_t, int, hash<uint32_t>, equal_to<uint32_t>, Alloc<pair<const uint32_t, int>, A>> u(0, hash<uint32_t>(), equal_to<uint32_t>(), Alloc<int, A>(*mem));
+
+                printf("%-14s %12.2f %12.2f %12.2f\n", name, run_list(l), run_map(m), run_map(u));
+            }
+
+            delete mem;
+        }
+
+        template<typename A>
+        void run_pmr(const char *name) {
+            A *mem = new A();
+            MemResource<A> res(*mem);
+
+            {
+                pmr::list<int> l(&res);
+                pmr::map<uint32_t, int> m(&res);
+                pmr::unordered_map<uint32_t, int> u(&res);
+
+                printf("%-14s %12.2f %12.2f %12.2f\n", name, run_list(l), run_map(m), run_map(u));
+            }
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- node containers, " << NODE_AMNT << " nodes (ns per insert/erase) ---" << endl;
+            printf("%-14s %12s %12s %12s\n", "", "list", "map", "unordered");
+
+            {
+                list<int> l;
+                map<uint32_t, int> m;
+                unordered_map<uint32_t, int> u;
+
+                printf("%-14s %12.2f %12.2f %12.2f\n", "std::allocator", run_list(l), run_map(m), run_map(u));
+            }
+
+            run_heap<Fast>("FAST");
+            run_heap<Precise>("PRECISE");
+            run_pmr<Fast>("pmr FAST");
+            run_pmr<Precise>("pmr PRECISE");
+        }
+};
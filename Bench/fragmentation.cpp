@@ -0,0 +1,105 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <random>
+
+using namespace std;
+
+// long running mixed size workload, afterwards: how much of the heap is free, and how much of that is still usable.
+// deferred PRECISE leaves its cached blocks unmerged, the idle row calls compact() every so often and before the report
+class Fragmentation {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 1024*1024*1024;
+
+        static constexpr    uint8_t     BIG_FREE        = 10;   // bucket of 1K free blocks
+
+        static constexpr    int         OP_AMNT         = 4'000'000,
+                                        MAX_LIVE        = 50'000,
+                                        IDLE_EVERY      = 10'000;
+
+        struct Deferred : MemAllocator<PRECISE, MEM_SIZE> {
+            Deferred() : MemAllocator<PRECISE, MEM_SIZE>(options()) {}
+
+            static MemOptions options() {
+                MemOptions opts;
+                opts.deferCoalescing = true;
+                return opts;
+            }
+        };
+
+        struct Idle : Deferred {};
+
+        template<typename A>
+        static inline void idle(A &) {}
+        static inline void idle(Idle &mem) { mem.compact(); }
+
+        // mostly small, some medium and a few large sizes
+        size_t random_size(mt19937 &gen) const {
+            const unsigned r = gen() % 100;
+
+            if(r < 70)  return 16 + gen() % 112;
+            if(r < 95)  return 128 + gen() % 896;
+            return 1024 + gen() % 15360;
+        }
+
+        template<typename A>
+        void run_alloc(const char *name) {
+            A *mem = new A();
+            mt19937 gen(3);
+            vector<pair<void*, size_t>> live;
+            size_t liveBytes = 0;
+
+            for(int i = 0; i < OP_AMNT; i++) {
+                if(i % IDLE_EVERY == 0)
+                    idle(*mem);
+
+                // the live set slowly swings between empty and MAX_LIVE
+                const int target = MAX_LIVE / 2 + (MAX_LIVE / 2) * ((i / 500'000) % 2 ? -1 : 1) * (i % 500'000) / 500'000;
+
+                if(live.empty() || ((int)live.size() < target && gen() % 4)) {
+                    const size_t size = random_size(gen);
+                    void *x = mem->mem_alloc(size);
+                    if(!x)
+                        break;
+
+                    live.push_back({ x, size });
+                    liveBytes += size;
+                    continue;
+                }
+
+                const size_t idx = gen() % live.size();
+                mem->mem_free(live[idx].first);
+                liveBytes -= live[idx].second;
+                live[idx] = live.back();
+                live.pop_back();
+            }
+
+            idle(*mem);
+            const MemReport r = mem->report();
+
+            // bytes in free blocks big enough for a 1K request
+            size_t big = 0;
+            for(uint8_t i = BIG_FREE; i < MemReport::BUCKET_NUM; i++)
+                big += r.freeSize[i];
+
+            printf("%-10s %10.2f %10.2f %10.2f %10.2f %9.1f%% %9.1f%%\n", name,
+                   r.used / 1048576.0, liveBytes / 1048576.0, r.freeBytes / 1048576.0, r.largestFree / 1024.0,
+                   100.0 * r.fragmentation(), (r.freeBytes ? 100.0 * big / r.freeBytes : 0.0));
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- fragmentation after " << OP_AMNT << " random ops ---" << endl;
+            printf("%-10s %10s %10s %10s %10s %10s %10s\n", "", "heap MB", "live MB", "free MB", "largest KB", "ext frag", ">=1K free");
+
+            run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST");
+            run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE");
+            run_alloc<Deferred>("PRE defer");
+            run_alloc<Idle>("PRE idle");
+            run_alloc<MemAllocator<TLSF, MEM_SIZE>>("TLSF");
+        }
+};
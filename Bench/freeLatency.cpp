@@ -0,0 +1,55 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "benchUtil.cpp"
+#include <vector>
+
+using namespace std;
+
+// free cost with more and more free blocks in the same size class.
+// every free merges with a neighbour sitting somewhere in that list, which used to be a list walk
+class FreeLatency {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 256*1024*1024,
+                                        BLOCK_SIZE      = 64;
+
+        template<typename A>
+        void run_alloc(const char *name) {
+            printf("%s\n", name);
+
+            for(size_t listLen = 16; listLen <= 262'144; listLen *= 4) {
+                A *mem = new A();
+                vector<void*> x, a;
+                Samples frees(listLen);
+
+                // x | a | separator, freeing all a fills one size class with listLen blocks
+                for(size_t i = 0; i < listLen; i++) {
+                    x.push_back(mem->mem_alloc(BLOCK_SIZE));
+                    a.push_back(mem->mem_alloc(BLOCK_SIZE));
+                    mem->mem_alloc(BLOCK_SIZE);
+                }
+
+                for(void *p : a)
+                    mem->mem_free(p);
+
+                for(void *p : x) {
+                    const uint64_t c = cycles();
+                    mem->mem_free(p);
+                    frees.add(cycles() - c);
+                }
+
+                printf("  %10lu %8lu %8lu %8lu\n", listLen, frees.percentile(50), frees.percentile(99), frees.percentile(99.9));
+                delete mem;
+            }
+        }
+
+    public:
+        void run() {
+            cout << "--- free latency over free list length (cycles) ---" << endl;
+            printf("  %10s %8s %8s %8s\n", "list len", "p50", "p99", "p99.9");
+
+            run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE");
+            run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST");
+        }
+};
@@ -0,0 +1,77 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+// random access over a heap much bigger than the TLB reaches with 4K pages, for every page mode with and without prefaulting
+class PageModes {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 512*1024*1024,
+                                        NODE_SIZE       = 64,
+                                        NODE_AMNT       = 4'000'000,    // ~350MB with headers
+                                        ACCESS_AMNT     = 20'000'000;
+
+        using Alloc = MemAllocator<FAST, MEM_SIZE>;
+
+        volatile uint64_t *sink; // keeps the chase from being optimized out
+
+        static inline const char *name(const Pages p) {
+            return (p == HUGE_PAGES ? "hugetlb" : (p == TRANSPARENT_HUGE_PAGES ? "thp" : "4k"));
+        }
+
+        void run_mode(const MemOptions &opts) {
+            auto start = chrono::steady_clock::now();
+
+            Alloc *mem = new Alloc(opts);
+            const double ctorMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            // fill the heap, the first touch of every page is paid here unless it was prefaulted
+            vector<uint64_t*> v(NODE_AMNT);
+            start = chrono::steady_clock::now();
+
+            for(size_t i = 0; i < NODE_AMNT; i++) {
+                v[i] = (uint64_t*)mem->mem_alloc(NODE_SIZE);
+                *v[i] = i;
+            }
+
+            const double fillMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            // all nodes in one random cycle, chasing it misses the TLB on nearly every step with 4K pages
+            vector<uint64_t*> order(v);
+            shuffle(order.begin(), order.end(), mt19937_64(42));
+
+            for(size_t i = 0; i < NODE_AMNT; i++)
+                *order[i] = (uint64_t)order[(i + 1) % NODE_AMNT];
+
+            uint64_t *p = v[0];
+            start = chrono::steady_clock::now();
+
+            for(size_t i = 0; i < ACCESS_AMNT; i++)
+                p = (uint64_t*)*p;
+
+            const double accessNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / ACCESS_AMNT;
+            sink = p;
+
+            printf("%-8s %-9s %-8s %-9s %10.2f %10.2f %12.2f\n", name(opts.pages), (opts.prefault ? "yes" : "no"),
+                   name(mem->page_mode()), (mem->prefaulted() ? "yes" : "no"), ctorMs, fillMs, accessNs);
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- page modes, " << NODE_AMNT << " nodes of " << NODE_SIZE << "b, random pointer chase ---" << endl;
+            printf("%-8s %-9s %-8s %-9s %10s %10s %12s\n", "asked", "prefault", "got", "prefault", "ctor ms", "fill ms", "ns/access");
+
+            for(Pages p : { SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGE_PAGES })
+                for(bool prefault : { false, true })
+                    run_mode({ p, prefault });
+        }
+};
@@ -0,0 +1,94 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "../memPool.h"
+#include "benchUtil.cpp"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <new>
+
+using namespace std;
+
+// one type over and over, MemPool against new/delete and placement new on mem_alloc
+class Pool {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 64*1024*1024;
+
+        static constexpr    int         OP_AMNT         = 2'000'000,
+                                        LIVE_AMNT       = 10'000,
+                                        SEED            = 42;
+
+        struct Message {
+            uint64_t id, time;
+            char payload[48];
+
+            Message(const uint64_t id) : id(id), time(0) {}
+        };
+
+        struct NewDelete {
+            inline Message *create(const uint64_t id)   { return new Message(id); }
+            inline void destroy(Message *m)             { delete m; }
+        };
+
+        template<const Presets P>
+        struct Heap {
+            MemAllocator<P, MEM_SIZE> mem;
+
+            inline Message *create(const uint64_t id)   { return new(mem.mem_alloc(sizeof(Message))) Message(id); }
+            inline void destroy(Message *m)             { m->~Message(); mem.mem_free(m); }
+        };
+
+        struct Pooled {
+            MemPool<Message, LIVE_AMNT> pool;
+
+            inline Message *create(const uint64_t id)   { return pool.create(id); }
+            inline void destroy(Message *m)             { pool.destroy(m); }
+        };
+
+        // a random live message gets replaced by a new one
+        template<typename A>
+        void run_alloc(const char *name) {
+            A *a = new A();
+            mt19937 gen(SEED);
+            vector<Message*> live(LIVE_AMNT);
+            Samples s(OP_AMNT);
+
+            for(int i = 0; i < LIVE_AMNT; i++)
+                live[i] = a->create(i);
+
+            const auto start = chrono::steady_clock::now();
+
+            for(int i = 0; i < OP_AMNT / 2; i++) {
+                Message *&m = live[gen() % LIVE_AMNT];
+
+                uint64_t c = cycles();
+                a->destroy(m);
+                s.add(cycles() - c);
+
+                c = cycles();
+                m = a->create(i);
+                s.add(cycles() - c);
+            }
+
+            const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / OP_AMNT;
+            printf("%-10s %10.1f %8lu %8lu\n", name, ns, s.percentile(50), s.percentile(99));
+
+            for(Message *m : live)
+                a->destroy(m);
+
+            delete a;
+        }
+
+    public:
+        void run() {
+            cout << "--- typed pool, " << sizeof(Message) << "b objects, " << LIVE_AMNT << " live ---" << endl;
+            printf("%-10s %10s %8s %8s\n", "", "ns/op", "p50", "p99");
+
+            run_alloc<Pooled>("MemPool");
+            run_alloc<Heap<FAST>>("FAST");
+            run_alloc<Heap<PRECISE>>("PRECISE");
+            run_alloc<NewDelete>("new");
+        }
+};
@@ -0,0 +1,69 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+
+using namespace std;
+
+// request scoped memory: every request allocates a bunch of small blocks and drops them all at the end.
+// BUMP drops them with one reset(), the others free every block
+class RequestArena {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 64*1024*1024;
+
+        static constexpr    int         REQUEST_AMNT    = 100'000,
+                                        BLOCK_AMNT      = 200,          // blocks per request
+                                        SEED            = 42;
+
+        struct Malloc {
+            inline void *mem_alloc(const size_t size)   { return malloc(size); }
+            inline void mem_free(void *ptr)             { free(ptr); }
+        };
+
+        template<typename A>
+        static inline void end_request(A &mem, vector<void*> &v) {
+            for(void *x : v)
+                mem.mem_free(x);
+        }
+
+        static inline void end_request(MemAllocator<BUMP, MEM_SIZE> &mem, vector<void*> &) {
+            mem.reset();
+        }
+
+        template<typename A>
+        void run_alloc(const char *name) {
+            A *mem = new A();
+            mt19937 gen(SEED);
+            uniform_int_distribution<> sizeDist(8, 256);
+            vector<void*> v(BLOCK_AMNT);
+
+            const auto start = chrono::steady_clock::now();
+
+            for(int r = 0; r < REQUEST_AMNT; r++) {
+                for(void *&x : v)
+                    x = mem->mem_alloc(sizeDist(gen));
+
+                end_request(*mem, v);
+            }
+
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            printf("%-10s %12.2f %12.1f\n", name, sec * 1e9 / REQUEST_AMNT, sec * 1e9 / ((double)REQUEST_AMNT * BLOCK_AMNT));
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- request arenas, " << BLOCK_AMNT << " blocks of 8-256b per request ---" << endl;
+            printf("%-10s %12s %12s\n", "", "ns/request", "ns/block");
+
+            run_alloc<MemAllocator<BUMP, MEM_SIZE>>("BUMP");
+            run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST");
+            run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE");
+            run_alloc<Malloc>("malloc");
+        }
+};
@@ -0,0 +1,158 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <sys/wait.h>
+
+using namespace std;
+
+// a producer process hands big messages to a consumer. over a pipe every byte is copied twice,
+// with a SHARED heap only the offset goes through the pipe and the consumer reads the block where the producer wrote it
+class SharedIpc {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 256*1024*1024;
+
+        static constexpr    int         MSG_AMNT        = 2000,
+                                        IN_FLIGHT       = 16;   // the pipe holds offsets of at most this many messages
+
+        using Alloc = MemAllocator<SHARED, MEM_SIZE>;
+
+        volatile uint64_t sink = 0; // keeps the reads from being optimized out
+
+        // the consumer touches every page, a copy would have to as well
+        static inline uint64_t consume(const char *msg, const size_t size) {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < size; i += 4096)
+                sum += msg[i];
+
+            return sum;
+        }
+
+        static inline bool read_all(const int fd, void *buf, size_t size) {
+            for(char *p = (char*)buf; size;) {
+                const ssize_t n = read(fd, p, size);
+                if(n <= 0)
+                    return false;
+
+                p += n;
+                size -= n;
+            }
+
+            return true;
+        }
+
+        static inline bool write_all(const int fd, const void *buf, size_t size) {
+            for(const char *p = (const char*)buf; size;) {
+                const ssize_t n = write(fd, p, size);
+                if(n <= 0)
+                    return false;
+
+                p += n;
+                size -= n;
+            }
+
+            return true;
+        }
+
+        double run_pipe(const size_t size) {
+            int fds[2];
+            if(pipe(fds))
+                return 0;
+
+            const auto start = chrono::steady_clock::now();
+
+            if(!fork()) {
+                close(fds[0]);
+                vector<char> msg(size);
+
+                for(int i = 0; i < MSG_AMNT; i++) {
+                    memset(msg.data(), i, size);
+                    if(!write_all(fds[1], msg.data(), size))
+                        _exit(1);
+                }
+
+                _exit(0);
+            }
+
+            close(fds[1]);
+            vector<char> msg(size);
+            uint64_t sum = 0;
+
+            for(int i = 0; i < MSG_AMNT && read_all(fds[0], msg.data(), size); i++)
+                sum += consume(msg.data(), size);
+
+            close(fds[0]);
+            wait(nullptr);
+
+            sink += sum;
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+        // offsets go one way, a token per freed message comes back so the producer doesnt run the heap full
+        double run_shared(const size_t size) {
+            const string name = "/memAllocBench-" + to_string(getpid());
+            Alloc mem(name.c_str());
+            int offsets[2], tokens[2];
+
+            if(pipe(offsets) || pipe(tokens))
+                return 0;
+
+            const auto start = chrono::steady_clock::now();
+
+            if(!fork()) {
+                Alloc producer(name.c_str());
+                char token;
+
+                for(int i = 0; i < MSG_AMNT; i++) {
+                    if(i >= IN_FLIGHT && read(tokens[0], &token, 1) != 1)
+                        _exit(1);
+
+                    char *msg = (char*)producer.mem_alloc(size);
+                    memset(msg, i, size);
+
+                    const size_t off = producer.offset_of(msg);
+                    if(!write_all(offsets[1], &off, sizeof(off)))
+                        _exit(1);
+                }
+
+                _exit(0);
+            }
+
+            uint64_t sum = 0;
+            size_t off;
+
+            for(int i = 0; i < MSG_AMNT && read_all(offsets[0], &off, sizeof(off)); i++) {
+                char *msg = (char*)mem.at(off);
+                sum += consume(msg, size);
+                mem.mem_free(msg);
+
+                const char token = 0;
+                if(write(tokens[1], &token, 1) != 1)
+                    break;
+            }
+
+            wait(nullptr);
+            for(int fd : { offsets[0], offsets[1], tokens[0], tokens[1] })
+                close(fd);
+
+            Alloc::unlink(name.c_str());
+
+            sink += sum;
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+
+    public:
+        void run() {
+            cout << "--- " << MSG_AMNT << " messages from one process to another (GB/s) ---" << endl;
+            printf("%-10s %10s %10s\n", "size", "pipe", "SHARED");
+
+            for(size_t size = 64*1024; size <= 4*1024*1024; size *= 4) {
+                const double bytes = (double)size * MSG_AMNT;
+                printf("%-10zu %10.2f %10.2f\n", size, bytes / run_pipe(size) / 1e9, bytes / run_shared(size) / 1e9);
+            }
+        }
+};
@@ -0,0 +1,64 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "benchUtil.cpp"
+#include <vector>
+#include <cstdlib>
+#include <malloc.h>
+
+using namespace std;
+
+// memory per small object and what that means for objects per cache line
+class SlabDensity {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 512*1024*1024;
+
+        static constexpr    int         OBJ_AMNT        = 1'000'000;
+
+        struct Malloc {
+            inline void *mem_alloc(const size_t size)   { return malloc(size); }
+            inline void mem_free(void *ptr)             { free(ptr); }
+        };
+
+        template<typename A>
+        void run_alloc(const char *name, const size_t objSize) {
+            vector<void*> v(OBJ_AMNT);
+
+            // glibc keeps what the last run freed and would serve these objects from pages already counted
+            malloc_trim(0);
+            const size_t rss = rss_bytes();
+
+            A *mem = new A();
+
+            const auto start = chrono::steady_clock::now();
+            for(void *&x : v)
+                x = mem->mem_alloc(objSize);
+
+            const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / OBJ_AMNT;
+            const double perObj = (double)(rss_bytes() - rss) / OBJ_AMNT;
+
+            printf("%-10s %6zu %12.1f %12.2f %10.1f\n", name, objSize, perObj, 64.0 / perObj, ns);
+
+            for(void *x : v)
+                mem->mem_free(x);
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- small object density, " << OBJ_AMNT << " objects ---" << endl;
+            printf("%-10s %6s %12s %12s %10s\n", "", "size", "bytes/obj", "objs/line", "ns/alloc");
+
+            // compact headers only pay off where the 8 bytes they save cross an ALIGNMENT step (24b, 40b)
+            for(size_t size : { 4, 16, 24, 32, 40, 64 }) {
+                run_alloc<MemAllocator<SLAB, MEM_SIZE>>("SLAB", size);
+                run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST", size);
+                run_alloc<MemAllocator<FAST, MEM_SIZE, alignof(max_align_t), NoStats, CompactHeader>>("FAST c", size);
+                run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE", size);
+                run_alloc<MemAllocator<PRECISE, MEM_SIZE, alignof(max_align_t), NoStats, CompactHeader>>("PRECISE c", size);
+                run_alloc<Malloc>("malloc", size);
+            }
+        }
+};
@@ -0,0 +1,101 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "benchUtil.cpp"
+#include <vector>
+#include <random>
+#include <cstdlib>
+
+using namespace std;
+
+// per op cycles with random sizes and a random live set, the tail is what TLSF is for.
+// PRECISE also runs with deferred coalescing, once merging on misses only and once with compact() in between (idle)
+class TailLatency {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 256*1024*1024;
+
+        static constexpr    int         LIVE_AMNT       = 10'000,
+                                        OP_AMNT         = 1'000'000,
+                                        MAX_SIZE        = 8192;
+
+        struct Malloc {
+            inline void *mem_alloc(const size_t size)   { return malloc(size); }
+            inline void mem_free(void *ptr)             { free(ptr); }
+        };
+
+        struct Deferred : MemAllocator<PRECISE, MEM_SIZE> {
+            Deferred() : MemAllocator<PRECISE, MEM_SIZE>(options()) {}
+
+            static MemOptions options() {
+                MemOptions opts;
+                opts.deferCoalescing = true;
+                return opts;
+            }
+        };
+
+        struct Idle : Deferred {};
+
+        static constexpr    int         IDLE_EVERY      = 1000;
+
+        // the untimed gaps between ops, only Idle does something with them
+        template<typename A>
+        static inline void idle(A &) {}
+        static inline void idle(Idle &mem) { mem.compact(); }
+
+        void print(const char *name, Samples &s) const {
+            printf("%-10s %8lu %8lu %8lu %10lu\n", name,
+                   s.percentile(50), s.percentile(99), s.percentile(99.9), s.max());
+        }
+
+        // replace a random live block with a new one of random size, over and over
+        template<typename A>
+        void run_alloc(const char *name) {
+            A *mem = new A();
+            mt19937 gen(1);
+            uniform_int_distribution<> sizeDist(16, MAX_SIZE);
+            vector<void*> live(LIVE_AMNT);
+            Samples allocs(OP_AMNT), frees(OP_AMNT);
+
+            for(void *&x : live)
+                x = mem->mem_alloc(sizeDist(gen));
+
+            for(int i = 0; i < OP_AMNT; i++) {
+                if(i % IDLE_EVERY == 0)
+                    idle(*mem);
+
+                void *&x = live[gen() % LIVE_AMNT];
+                const size_t size = sizeDist(gen);
+
+                uint64_t c = cycles();
+                mem->mem_free(x);
+                frees.add(cycles() - c);
+
+                c = cycles();
+                x = mem->mem_alloc(size);
+                allocs.add(cycles() - c);
+            }
+
+            printf("%s\n", name);
+            print("  alloc", allocs);
+            print("  free", frees);
+
+            for(void *x : live)
+                mem->mem_free(x);
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- tail latency (cycles) ---" << endl;
+            printf("%-10s %8s %8s %8s %10s\n", "", "p50", "p99", "p99.9", "max");
+
+            run_alloc<MemAllocator<FAST, MEM_SIZE>>("FAST");
+            run_alloc<MemAllocator<PRECISE, MEM_SIZE>>("PRECISE");
+            run_alloc<Deferred>("PRECISE deferred");
+            run_alloc<Idle>("PRECISE deferred, idle compact");
+            run_alloc<MemAllocator<TLSF, MEM_SIZE>>("TLSF");
+            run_alloc<Malloc>("malloc");
+        }
+};
@@ -0,0 +1,148 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace std;
+
+// alloc/free throughput of THREADED and CONCURRENT against a FAST heap behind one mutex and glibc malloc at 1-64 threads
+class ThreadScaling {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 1024*1024*1024;
+
+        static constexpr    int         ROUNDS          = 200,
+                                        BATCH           = 256;
+
+        using Threaded  = MemAllocator<THREADED, MEM_SIZE>;
+        using Shared    = MemAllocator<CONCURRENT, MEM_SIZE>;
+        using Fast      = MemAllocator<FAST, MEM_SIZE>;
+
+        // all threads wait until the last one arrived, then start the next phase together
+        class Barrier {
+            private:
+                const int           count;
+                atomic<int>         waiting     { 0 };
+                atomic<int>         generation  { 0 };
+
+            public:
+                Barrier(const int count) : count(count) {}
+
+                void wait() {
+                    const int gen = generation.load();
+
+                    if(waiting.fetch_add(1) + 1 == count) {
+                        waiting.store(0);
+                        generation.fetch_add(1);
+                        return;
+                    }
+
+                    while(generation.load() == gen)
+                        this_thread::yield();
+                }
+        };
+
+        struct ThreadedAlloc {
+            Threaded mem;
+
+            inline void *alloc(const size_t size)   { return mem.mem_alloc(size); }
+            inline void free(void *ptr)             { mem.mem_free(ptr); }
+        };
+
+        struct ConcurrentAlloc {
+            Shared mem;
+
+            inline void *alloc(const size_t size)   { return mem.mem_alloc(size); }
+            inline void free(void *ptr)             { mem.mem_free(ptr); }
+        };
+
+        struct LockedAlloc {
+            Fast mem;
+            mutex m;
+
+            inline void *alloc(const size_t size)   { lock_guard<mutex> l(m); return mem.mem_alloc(size); }
+            inline void free(void *ptr)             { lock_guard<mutex> l(m); mem.mem_free(ptr); }
+        };
+
+        struct Malloc {
+            inline void *alloc(const size_t size)   { return malloc(size); }
+            inline void free(void *ptr)             { ::free(ptr); }
+        };
+
+        // every thread allocates a batch and frees it again itself
+        // remote: every thread frees the batch of its neighbour instead
+        template<typename A>
+        double run_threads(A &a, const int threadAmnt, const bool remote) {
+            vector<vector<void*>> batches(threadAmnt, vector<void*>(BATCH));
+            vector<thread> threads;
+            Barrier barrier(threadAmnt);
+
+            const auto start = chrono::steady_clock::now();
+
+            for(int t = 0; t < threadAmnt; t++)
+                threads.emplace_back([&, t]() {
+                    mt19937 gen(t);
+                    uniform_int_distribution<> dist(8, 256);
+
+                    vector<void*> &own = batches[t];
+                    vector<void*> &other = batches[(remote ? (t + 1) % threadAmnt : t)];
+
+                    for(int r = 0; r < ROUNDS; r++) {
+                        for(void *&x : own)
+                            x = a.alloc(dist(gen));
+
+                        if(remote)
+                            barrier.wait();
+
+                        for(void *x : other)
+                            a.free(x);
+
+                        if(remote)
+                            barrier.wait();
+                    }
+                });
+
+            for(thread &t : threads)
+                t.join();
+
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            return 2.0 * ROUNDS * BATCH * threadAmnt / sec / 1e6; // Mops/s, alloc + free
+        }
+
+        void run_workload(const bool remote) {
+            printf("\n%s frees (Mops/s)\n", (remote ? "remote" : "local"));
+            printf("%8s %12s %12s %12s %12s\n", "threads", "THREADED", "CONCURRENT", "FAST+mutex", "malloc");
+
+            for(int n = 1; n <= 64; n *= 2) {
+                ThreadedAlloc *ta = new ThreadedAlloc();
+                ConcurrentAlloc *ca = new ConcurrentAlloc();
+                LockedAlloc *la = new LockedAlloc();
+                Malloc ma;
+
+                printf("%8d %12.2f %12.2f %12.2f %12.2f\n", n,
+                       run_threads(*ta, n, remote),
+                       run_threads(*ca, n, remote),
+                       run_threads(*la, n, remote),
+                       run_threads(ma, n, remote));
+
+                delete ta;
+                delete ca;
+                delete la;
+            }
+        }
+
+    public:
+        void run() {
+            cout << "--- thread scaling ---" << endl;
+
+            run_workload(false);
+            run_workload(true);
+        }
+};
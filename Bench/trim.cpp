@@ -0,0 +1,101 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "benchUtil.cpp"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+
+using namespace std;
+
+// a load spike and the quiet time after it: how much stays resident once most blocks are gone, with mem_free alone,
+// with a trimThreshold and after mem_trim. malloc is measured on the process RSS and trimmed with malloc_trim
+class Trim {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 1024*1024*1024,
+                                        SPIKE_BYTES     = 256*1024*1024,
+                                        THRESHOLD       = 256*1024;
+
+        static constexpr    int         KEEP_EVERY      = 20,           // one block in 20 outlives the spike
+                                        SEED            = 42;
+
+        struct Malloc {
+            size_t base = rss_bytes();
+
+            inline void *mem_alloc(const size_t size)   { return malloc(size); }
+            inline void mem_free(void *ptr)             { free(ptr); }
+            inline size_t resident() const              { const size_t r = rss_bytes(); return (r > base ? r - base : 0); }
+            inline size_t mem_trim(size_t)              { malloc_trim(0); return 0; }
+        };
+
+        template<const Presets P, const size_t THRESHOLD_BYTES = 0>
+        struct Heap : MemAllocator<P, MEM_SIZE> {
+            Heap() : MemAllocator<P, MEM_SIZE>(options()) {}
+
+            static MemOptions options() {
+                MemOptions opts;
+                opts.trimThreshold = THRESHOLD_BYTES;
+                return opts;
+            }
+
+            inline size_t resident() { return this->stats().resident; }
+        };
+
+        template<typename A>
+        void run_alloc(const char *name) {
+            A *mem = new A();
+            mt19937 gen(SEED);
+            uniform_int_distribution<> sizeDist(16, 64*1024);
+            vector<void*> v;
+
+            // the spike, every block gets written so its pages are really there
+            for(size_t bytes = 0; bytes < SPIKE_BYTES;) {
+                const size_t size = sizeDist(gen);
+                void *x = mem->mem_alloc(size);
+                memset(x, 1, size);
+
+                v.push_back(x);
+                bytes += size;
+            }
+
+            const size_t spike = mem->resident();
+
+            // it passes, a few scattered blocks stay, newest first
+            auto start = chrono::steady_clock::now();
+
+            for(size_t i = v.size(); i-- > 0;)
+                if(i % KEEP_EVERY)
+                    mem->mem_free(v[i]);
+
+            const double freeNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / v.size();
+            const size_t idle = mem->resident();
+
+            start = chrono::steady_clock::now();
+            mem->mem_trim(0);
+            const double trimMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            printf("%-14s %10.1f %10.1f %10.1f %10.1f %10.2f\n", name,
+                   spike / 1048576.0, idle / 1048576.0, mem->resident() / 1048576.0, freeNs, trimMs);
+
+            for(size_t i = 0; i < v.size(); i += KEEP_EVERY)
+                mem->mem_free(v[i]);
+
+            delete mem;
+        }
+
+    public:
+        void run() {
+            cout << "--- resident MB after a " << SPIKE_BYTES / 1048576 << "MB spike, 1 in " << KEEP_EVERY << " blocks kept ---" << endl;
+            printf("%-14s %10s %10s %10s %10s %10s\n", "", "spike", "freed", "trimmed", "ns/free", "trim ms");
+
+            run_alloc<Heap<FAST>>("FAST");
+            run_alloc<Heap<FAST, THRESHOLD>>("FAST 256K");
+            run_alloc<Heap<PRECISE>>("PRECISE");
+            run_alloc<Heap<PRECISE, THRESHOLD>>("PRECISE 256K");
+            run_alloc<Malloc>("malloc");
+        }
+};
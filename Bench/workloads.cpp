@@ -0,0 +1,212 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "benchUtil.cpp"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// the standard workloads for FAST, PRECISE and malloc side by side, every run is seeded the same.
+// each workload runs in its own forked process, so the peak RSS belongs to that workload alone
+class Workloads {
+    private:
+        friend class Benchmarks;
+
+        static constexpr    size_t      MEM_SIZE        = 256*1024*1024;
+
+        static constexpr    int         SEED            = 42,
+                                        OP_AMNT         = 1'000'000,
+                                        LIVE_AMNT       = 10'000,
+                                        ORDER_AMNT      = 1'000,        // blocks per LIFO/FIFO round
+                                        BUFFER_AMNT     = 100,          // buffers grown at once by realloc
+                                        MAX_BUFFER      = 64*1024,
+                                        FILL_SIZE       = 1024;
+
+        // realloc gets the old size too, for heaps without a mem_realloc
+        struct Fast {
+            MemAllocator<FAST, MEM_SIZE> mem;
+
+            inline void *alloc(const size_t size)                       { return mem.mem_alloc(size); }
+            inline void free(void *ptr)                                 { mem.mem_free(ptr); }
+            inline void *realloc(void *ptr, size_t, const size_t size)  { return mem.mem_realloc(ptr, size); }
+        };
+
+        struct Precise {
+            MemAllocator<PRECISE, MEM_SIZE> mem;
+
+            inline void *alloc(const size_t size)                       { return mem.mem_alloc(size); }
+            inline void free(void *ptr)                                 { mem.mem_free(ptr); }
+            inline void *realloc(void *ptr, size_t, const size_t size)  { return mem.mem_realloc(ptr, size); }
+        };
+
+        struct Malloc {
+            inline void *alloc(const size_t size)                       { return malloc(size); }
+            inline void free(void *ptr)                                 { ::free(ptr); }
+            inline void *realloc(void *ptr, size_t, const size_t size)  { return ::realloc(ptr, size); }
+        };
+
+        // times a single call, the result stays in x
+        #define TIMED(s, x) { const uint64_t c = cycles(); x; s.add(cycles() - c); }
+
+        // the same size over and over, a random live block gets replaced
+        template<typename A>
+        void churn(A &a, mt19937 &gen, Samples &s) {
+            vector<void*> live(LIVE_AMNT);
+            for(void *&x : live)
+                x = a.alloc(64);
+
+            for(int i = 0; i < OP_AMNT / 2; i++) {
+                void *&x = live[gen() % LIVE_AMNT];
+
+                TIMED(s, a.free(x));
+                TIMED(s, x = a.alloc(64));
+            }
+
+            for(void *x : live)
+                a.free(x);
+        }
+
+        // same as churn, but every new block has a random size
+        template<typename A>
+        void random_sizes(A &a, mt19937 &gen, Samples &s) {
+            uniform_int_distribution<> sizeDist(1, 4096);
+            vector<void*> live(LIVE_AMNT);
+            for(void *&x : live)
+                x = a.alloc(sizeDist(gen));
+
+            for(int i = 0; i < OP_AMNT / 2; i++) {
+                void *&x = live[gen() % LIVE_AMNT];
+                const size_t size = sizeDist(gen);
+
+                TIMED(s, a.free(x));
+                TIMED(s, x = a.alloc(size));
+            }
+
+            for(void *x : live)
+                a.free(x);
+        }
+
+        // rounds of allocs, freed newest first (lifo) or oldest first
+        template<typename A>
+        void free_order(A &a, mt19937 &gen, Samples &s, const bool lifo) {
+            uniform_int_distribution<> sizeDist(16, 512);
+            vector<void*> v(ORDER_AMNT);
+
+            for(int r = 0; r < OP_AMNT / (2 * ORDER_AMNT); r++) {
+                for(void *&x : v) {
+                    const size_t size = sizeDist(gen);
+                    TIMED(s, x = a.alloc(size));
+                }
+
+                for(int i = 0; i < ORDER_AMNT; i++)
+                    TIMED(s, a.free(v[(lifo ? ORDER_AMNT - 1 - i : i)]));
+            }
+        }
+
+        // buffers growing by 1.5 from 16b up to MAX_BUFFER, a random one grows each step
+        template<typename A>
+        void realloc_growth(A &a, mt19937 &gen, Samples &s) {
+            vector<pair<void*, size_t>> bufs(BUFFER_AMNT, { nullptr, 0 });
+
+            for(int i = 0; i < OP_AMNT; i++) {
+                auto &[x, size] = bufs[gen() % BUFFER_AMNT];
+
+                if(!x) {
+                    size = 16;
+                    TIMED(s, x = a.alloc(size));
+                    continue;
+                }
+
+                if(size * 3 / 2 > MAX_BUFFER) {
+                    TIMED(s, a.free(x));
+                    x = nullptr;
+                    continue;
+                }
+
+                const size_t newSize = size * 3 / 2;
+                TIMED(s, x = a.realloc(x, size, newSize));
+                size = newSize;
+            }
+
+            for(auto &[x, size] : bufs)
+                if(x)
+                    a.free(x);
+        }
+
+        // like max_alloc_and_free, fill the whole heap with one size and free it again.
+        // malloc stops after as many bytes as the heaps have
+        template<typename A>
+        void fill(A &a, mt19937 &, Samples &s) {
+            vector<void*> v;
+            v.reserve(MEM_SIZE / FILL_SIZE);
+
+            while(v.size() < MEM_SIZE / (FILL_SIZE + 32)) {
+                void *x;
+                TIMED(s, x = a.alloc(FILL_SIZE));
+                if(!x)
+                    break;
+
+                v.push_back(x);
+            }
+
+            for(void *x : v)
+                TIMED(s, a.free(x));
+        }
+
+        #undef TIMED
+
+        enum Workload { CHURN, RANDOM, LIFO, FIFO, REALLOC, FILL };
+
+        static constexpr    const char  *WORKLOAD_NAMES[]   = { "churn", "random", "lifo", "fifo", "realloc", "fill" };
+
+        template<typename A>
+        void run_workload(const Workload w, const char *name) {
+            fflush(stdout);
+
+            if(fork()) {
+                wait(nullptr);
+                return;
+            }
+
+            A *a = new A();
+            mt19937 gen(SEED);
+            Samples s(2 * OP_AMNT);
+
+            const auto start = chrono::steady_clock::now();
+
+            switch(w) {
+                case CHURN:     churn(*a, gen, s);                  break;
+                case RANDOM:    random_sizes(*a, gen, s);           break;
+                case LIFO:      free_order(*a, gen, s, true);       break;
+                case FIFO:      free_order(*a, gen, s, false);      break;
+                case REALLOC:   realloc_growth(*a, gen, s);         break;
+                case FILL:      fill(*a, gen, s);                   break;
+            }
+
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            printf("%-10s %-8s %10.2f %8lu %8lu %8lu %10.1f\n", WORKLOAD_NAMES[w], name, s.size() / sec / 1e6,
+                   s.percentile(50), s.percentile(99), s.percentile(99.9), peak_rss_bytes() / (1024.0 * 1024.0));
+            fflush(stdout);
+
+            delete a;
+            _exit(0);
+        }
+
+    public:
+        void run() {
+            cout << "--- workloads (seed " << SEED << ", cycles per op) ---" << endl;
+            printf("%-10s %-8s %10s %8s %8s %8s %10s\n", "workload", "", "Mops/s", "p50", "p99", "p99.9", "peak MB");
+
+            for(Workload w : { CHURN, RANDOM, LIFO, FIFO, REALLOC, FILL }) {
+                run_workload<Fast>(w, "FAST");
+                run_workload<Precise>(w, "PRECISE");
+                run_workload<Malloc>(w, "malloc");
+            }
+        }
+};
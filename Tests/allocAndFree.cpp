@@ -19,15 +19,22 @@ class AllocAndFree {
         int        CHAR_TEST_AMNT; 
         int        STRING_TEST_AMNT;
 
+        // FAST with counters, the tests check them through stats()
+        using Tracked = MemAllocator<FAST, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats>; 
+
         inline size_t ran(size_t min = 0, size_t max = SIZE_MAX) const {
-            static random_device rd;
-            static mt19937 gen(rd());
+            static mt19937 gen(42); // seeded, so a failing run can be repeated
             uniform_int_distribution<> dist(min, max);
             return dist(gen);
         }
 
-        inline MemAllocator<FAST, Data::MEM_SIZE> get_alloc_instance() const {
-            return MemAllocator<FAST, Data::MEM_SIZE>();
+        // header + payload a FAST alloc of size takes up
+        inline size_t block_bytes(const size_t size) const {
+            return FAST_BLOCK_SIZE + Tracked::adjust_size(size); 
+        }
+
+        inline Tracked get_alloc_instance() const {
+            return Tracked();
         }
 
         pair<bool, int> pure_alloc() {
@@ -45,7 +52,7 @@ class AllocAndFree {
             }
             
             // all allocs completed?
-            if(mem.memAlloc != CHAR_TEST_AMNT) 
+            if(mem.stats().allocs != CHAR_TEST_AMNT) 
                 return { false, 1 }; 
             
             return { true, -1 }; 
@@ -61,7 +68,7 @@ class AllocAndFree {
             for(char *x : v) 
                 mem.mem_free(x); 
                
-            if(mem.memFree != CHAR_TEST_AMNT)
+            if(mem.stats().frees != CHAR_TEST_AMNT)
                 return { false, 0 }; 
             
             return { true, -1 }; 
@@ -82,7 +89,7 @@ class AllocAndFree {
             }
 
             // check if all frees and allocs where sucessful 
-            if(mem.memFree != CHAR_TEST_AMNT || mem.memAlloc != CHAR_TEST_AMNT + 1)
+            if(mem.stats().frees != CHAR_TEST_AMNT || mem.stats().allocs != CHAR_TEST_AMNT + 1)
         	    return { false, 1};
 
             return { true, -1 }; 
@@ -99,7 +106,7 @@ class AllocAndFree {
             if(mem.mem_free(b.get())) 
                 return { false, 1 }; 
 
-            if(mem.memFree > 0) 
+            if(mem.stats().frees > 0) 
                 return { false, 2 }; 
 
             return { true, -1 }; 
@@ -113,27 +120,27 @@ class AllocAndFree {
                 switch(ran(0, 4)) {
                     case 0: 
                         mem.mem_alloc(sizeof(char));
-                        byteAlloc += FAST_BLOCK_SIZE + mem.MIN_BLOCK_SIZE; // char < MIN_BLOCK_SIZE
+                        byteAlloc += block_bytes(sizeof(char)); // char < MIN_BLOCK_SIZE
                         break; 
 
                     case 1: 
                         mem.mem_alloc(sizeof(int));
-                        byteAlloc += FAST_BLOCK_SIZE + sizeof(int); 
+                        byteAlloc += block_bytes(sizeof(int)); 
                         break;
                     
                     case 2: 
                         mem.mem_alloc(sizeof(size_t));
-                        byteAlloc += FAST_BLOCK_SIZE + sizeof(size_t); 
+                        byteAlloc += block_bytes(sizeof(size_t)); 
                         break;
                     
                     case 3: 
                         mem.mem_alloc(24); 
-                        byteAlloc += FAST_BLOCK_SIZE + 24; 
+                        byteAlloc += block_bytes(24); 
                         break;
                     
                     case 4:     
                         mem.mem_alloc(sizeof(string));
-                        byteAlloc += FAST_BLOCK_SIZE + sizeof(string); 
+                        byteAlloc += block_bytes(sizeof(string)); 
                         break;
                 }
             }
@@ -145,7 +152,7 @@ class AllocAndFree {
         }
 
         pair<bool, int> max_alloc_and_free() { 
-            MemAllocator mem = get_alloc_instance();
+            Tracked mem({ SMALL_PAGES, false, 0 }); // no large blocks, everything has to come from the arena
             
             static const size_t maxAlloc = Data::MEM_SIZE - FAST_BLOCK_SIZE; 
             size_t byteAlloc = 0,
@@ -190,12 +197,813 @@ class AllocAndFree {
                 }
             }
 
-            if(freed != mem.memFree) 
+            if(freed != mem.stats().frees) 
+                return { false, 3 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> reserve_and_fill() {
+            // reserving is free, only what gets used is committed
+            MemAllocator<FAST, 64ull*1024*1024*1024> big; 
+            if(!big.mem_alloc(sizeof(size_t)) || big.arena.committed > 1024*1024) 
+                return { false, 0 }; 
+
+            // PRECISE has to stop at the end of the arena instead of walking off it
+            MemAllocator<PRECISE, Data::MEM_SIZE> mem; 
+            vector<void*> v; 
+
+            for(void *x = mem.mem_alloc(1024); x; x = mem.mem_alloc(1024)) 
+                v.push_back(x); 
+
+            if(v.size() != (Data::MEM_SIZE - mem.FIRST_BLOCK) / (mem.adjust_size(1024) + sizeof(decltype(mem)::Block))) 
+                return { false, 1 }; 
+
+            for(void *x : v) 
+                if(!mem.mem_free(x)) 
+                    return { false, 2 }; 
+
+            if(!mem.mem_alloc(1024)) 
+                return { false, 3 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> unlink_free_blocks() {
+            MemAllocator<PRECISE, Data::MEM_SIZE> mem; 
+            using Block = decltype(mem)::Block; 
+            vector<void*> x, a; 
+
+            // x | a | separator, so freeing x merges it with a, wherever a sits in its list
+            for(int i = 0; i < 1000; i++) {
+                x.push_back(mem.mem_alloc(64)); 
+                a.push_back(mem.mem_alloc(64)); 
+                mem.mem_alloc(64); 
+            }
+
+            for(void *p : a) 
+                mem.mem_free(p); 
+
+            for(void *p : x) 
+                mem.mem_free(p); 
+
+            // every a got merged into its x, links have to agree in both directions
+            size_t amnt = 0; 
+            for(Block *bl : mem.sizeClasses) {
+                Block *prev = nullptr; 
+
+                for(; bl; prev = bl, bl = mem.links(bl)->next) {
+                    if(mem.links(bl)->prev != prev || !(bl->offset & mem.FREE)) 
+                        return { false, 0 }; 
+
+                    if(bl->size != 2 * mem.adjust_size(64) + sizeof(Block)) 
+                        return { false, 1 }; 
+
+                    amnt++; 
+                }
+            }
+
+            if(amnt != x.size()) 
+                return { false, 2 }; 
+
+            return { true, -1 }; 
+        }
+
+        // walks a PRECISE heap, no two free blocks next to each other, every tag points back to its block and the top is never free
+        template<typename A> 
+        bool precise_tags(A &mem) {
+            using Block = typename A::Block; 
+            using Tag = typename A::Tag; 
+
+            bool prevFree = false; 
+            for(size_t off = mem.FIRST_BLOCK; off < mem.offset;) {
+                Block *bl = (Block*)((char*)mem.memory + off); 
+                const bool free = bl->offset & mem.FREE; 
+
+                if((bool)(bl->offset & mem.PREV_FREE) != prevFree || (prevFree && free)) 
+                    return false; 
+
+                if(free && *(Tag*)((char*)mem.next_block(bl) - sizeof(Tag)) != off) 
+                    return false; 
+
+                prevFree = free; 
+                off = mem.next_pos(bl); 
+            }
+
+            return !prevFree; 
+        }
+
+        template<typename A> 
+        pair<bool, int> precise_coalescing(A &mem) {
+            mt19937 gen(7); 
+            vector<void*> v; 
+
+            for(int i = 0; i < 1'000'000; i++) {
+                if(v.empty() || gen() % 2) {
+                    v.push_back(mem.mem_alloc(gen() % 2048 + 1)); 
+                    continue; 
+                }
+
+                const size_t idx = gen() % v.size(); 
+                mem.mem_free(v[idx]); 
+                v[idx] = v.back(); 
+                v.pop_back(); 
+            }
+
+            // walk the heap, no two free blocks next to each other and every tag points back to its block
+            if(!precise_tags(mem)) 
+                return { false, 0 }; 
+
+            // freeing everything merges it all back into the bump region, deferred frees once theyre compacted
+            for(void *x : v) 
+                mem.mem_free(x); 
+
+            mem.compact(); 
+
+            if(mem.offset != mem.FIRST_BLOCK) 
+                return { false, 3 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> precise_coalescing() {
+            unique_ptr<MemAllocator<PRECISE, Data::MEM_SIZE>> wide(new MemAllocator<PRECISE, Data::MEM_SIZE>()); 
+            unique_ptr<MemAllocator<PRECISE, Data::MEM_SIZE, alignof(std::max_align_t), NoStats, CompactHeader>> compact(
+                new MemAllocator<PRECISE, Data::MEM_SIZE, alignof(std::max_align_t), NoStats, CompactHeader>()); 
+
+            pair<bool, int> r; 
+            if(!(r = precise_coalescing(*wide)).first) 
+                return r; 
+
+            if(!(r = precise_coalescing(*compact)).first) 
+                return { false, r.second + 10 }; 
+
+            return { true, -1 }; 
+        }
+
+        // grows into the free neighbour or the bump region without moving, shrinking gives the tail back
+        pair<bool, int> precise_realloc() {
+            MemAllocator<PRECISE, Data::MEM_SIZE> mem; 
+
+            char *a = (char*)mem.mem_alloc(100), 
+                 *b = (char*)mem.mem_alloc(100), 
+                 *c = (char*)mem.mem_alloc(100); 
+
+            memset(a, 'a', 100); 
+            mem.mem_free(b); 
+
+            if(mem.mem_realloc(a, 150) != a || a[99] != 'a') 
+                return { false, 0 }; 
+
+            // c is the top
+            if(mem.mem_realloc(c, 5000) != c || mem.offset != (size_t)(c + mem.mem_usable_size(c) - (char*)mem.memory)) 
+                return { false, 1 }; 
+
+            if(mem.mem_realloc(c, 100) != c || mem.offset != (size_t)(c + mem.mem_usable_size(c) - (char*)mem.memory)) 
+                return { false, 2 }; 
+
+            // no room behind a, it has to move and take its data along
+            char *x = (char*)mem.mem_realloc(a, 1000); 
+            if(x == a || x[0] != 'a' || x[99] != 'a') 
+                return { false, 3 }; 
+
+            // buffers growing and shrinking by small steps, every one keeps its contents
+            mt19937 gen(11); 
+            vector<pair<char*, size_t>> v(64, { nullptr, 0 }); 
+
+            for(int i = 0; i < 100'000; i++) {
+                auto &[ptr, size] = v[gen() % v.size()]; 
+                const size_t newSize = (gen() % 4 ? size + gen() % 64 + 1 : gen() % 2048 + 1); 
+
+                char *y = (char*)mem.mem_realloc(ptr, newSize); 
+                if(!y) 
+                    return { false, 4 }; 
+
+                for(size_t k = 0; k < (size < newSize ? size : newSize); k++) 
+                    if(y[k] != (char)(uintptr_t)&size) 
+                        return { false, 5 }; 
+
+                memset(y, (char)(uintptr_t)&size, newSize); 
+                ptr = y; 
+                size = newSize; 
+            }
+
+            // tags and neighbours still have to be right
+            if(!precise_tags(mem)) 
+                return { false, 6 }; 
+
+            return { true, -1 }; 
+        }
+
+        // FAST: the tail of a shrunk block can be used again, big blocks move into their own mapping
+        pair<bool, int> fast_realloc() {
+            MemAllocator mem = get_alloc_instance(); 
+
+            char *a = (char*)mem.mem_alloc(1000), 
+                 *b = (char*)mem.mem_alloc(100); 
+            memset(a, 'a', 1000); 
+
+            if(mem.mem_realloc(a, 100) != a) 
+                return { false, 0 }; 
+
+            // the cut off tail sits between a and b
+            char *x = (char*)mem.mem_alloc(500); 
+            if(x <= a || x >= b) 
+                return { false, 1 }; 
+
+            // what split left of it is right behind a, a can grow into it
+            if(mem.mem_realloc(a, 300) != a || a[99] != 'a') 
+                return { false, 2 }; 
+
+            // b is the top
+            if(mem.mem_realloc(b, 5000) != b || mem.offset != (size_t)(b + mem.mem_usable_size(b) - (char*)mem.memory)) 
+                return { false, 3 }; 
+
+            // into a mapping, then grown there
+            char *big = (char*)mem.mem_realloc(a, 2*1024*1024); 
+            if(!big || (big >= mem.memory && big < (char*)mem.memory + Data::MEM_SIZE) || big[99] != 'a') 
+                return { false, 4 }; 
+
+            memset(big, 'b', 2*1024*1024); 
+            big = (char*)mem.mem_realloc(big, 64*1024*1024); 
+            if(!big || mem.mem_usable_size(big) < 64*1024*1024 || big[2*1024*1024 - 1] != 'b') 
+                return { false, 5 }; 
+
+            if(!mem.mem_free(big) || mem.mem_usable_size(big) || mem.mem_free(big)) 
+                return { false, 6 }; 
+
+            // buffers growing and shrinking, now and then past the mapping size, every one keeps its contents
+            mt19937 gen(13); 
+            vector<pair<char*, size_t>> v(64, { nullptr, 0 }); 
+
+            for(int i = 0; i < 20'000; i++) {
+                auto &[ptr, size] = v[gen() % v.size()]; 
+                const size_t newSize = (gen() % 100 == 0 ? gen() % (3*1024*1024) + 1 : (gen() % 4 ? size + gen() % 64 + 1 : gen() % 2048 + 1)); 
+
+                char *y = (char*)mem.mem_realloc(ptr, newSize); 
+                if(!y) 
+                    return { false, 7 }; 
+
+                for(size_t k = 0; k < (size < newSize ? size : newSize); k++) 
+                    if(y[k] != (char)(uintptr_t)&size) 
+                        return { false, 8 }; 
+
+                memset(y, (char)(uintptr_t)&size, newSize); 
+                ptr = y; 
+                size = newSize; 
+            }
+
+            // the heap has to stay walkable
+            const MemReport r = mem.report(); 
+            if(r.used != mem.mem_used() || r.headerBytes % FAST_BLOCK_SIZE) 
+                return { false, 9 }; 
+
+            for(auto &[ptr, size] : v) 
+                if(!mem.mem_free(ptr)) 
+                    return { false, 10 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> batch_alloc_and_free() {
+            static constexpr size_t BATCH = 1000; 
+            void *v[BATCH], *w[BATCH]; 
+
+            // FAST: a fresh batch is one contiguous run, a batch after freeing comes out of the size class
+            MemAllocator mem = get_alloc_instance(); 
+            if(mem.mem_alloc_batch(24, BATCH, v) != BATCH) 
+                return { false, 0 }; 
+
+            for(size_t i = 1; i < BATCH; i++) 
+                if((char*)v[i] != (char*)v[i - 1] + block_bytes(24)) 
+                    return { false, 1 }; 
+
+            const size_t offset = mem.offset; 
+            if(mem.mem_free_batch(v, BATCH) != BATCH || mem.mem_alloc_batch(24, BATCH, w) != BATCH || mem.offset != offset) 
+                return { false, 2 }; 
+
+            set<void*> s(v, v + BATCH); 
+            for(void *x : w) 
+                if(!s.erase(x)) 
+                    return { false, 3 }; 
+
+            // PRECISE: freeing the whole run merges it back into the bump region
+            MemAllocator<PRECISE, Data::MEM_SIZE> pmem; 
+            void *keep = pmem.mem_alloc(8); 
+
+            if(pmem.mem_alloc_batch(100, BATCH, v) != BATCH || pmem.mem_free_batch(v, BATCH) != BATCH) 
+                return { false, 4 }; 
+
+            if(pmem.offset != (char*)keep - (char*)pmem.memory + pmem.adjust_size(8)) 
+                return { false, 5 }; 
+
+            return { true, -1 }; 
+        }
+
+        // every alignment has to hold, gaps and tails cut off go back to the free lists
+        template<typename A>
+        pair<bool, int> aligned_alloc(A &mem) {
+            vector<void*> v; 
+
+            for(size_t align = 32; align <= 4096; align *= 2) 
+                for(int i = 0; i < 100; i++) {
+                    void *x = mem.mem_alloc_aligned(i * 7 + 1, align); 
+                    if(!x || (uintptr_t)x % align) 
+                        return { false, 0 }; 
+
+                    memset(x, 0xab, i * 7 + 1); 
+                    v.push_back(x); 
+                    v.push_back(mem.mem_alloc(i % 3 * 40 + 1)); // something in between for the next gap
+                }
+
+            // stays, so PRECISE can't hand everything back to the bump region
+            if(!mem.mem_alloc(8)) 
+                return { false, 1 }; 
+
+            for(void *x : v) 
+                if(!mem.mem_free(x)) 
+                    return { false, 1 }; 
+
+            // the same again has to fit into what got freed
+            const size_t offset = mem.offset; 
+            for(int i = 0; i < 100; i++) 
+                if((uintptr_t)mem.mem_alloc_aligned(64, 64) % 64) 
+                    return { false, 2 }; 
+
+            if(mem.offset != offset) 
                 return { false, 3 }; 
 
             return { true, -1 }; 
         }
 
+        pair<bool, int> aligned_alloc() {
+            MemAllocator<FAST, Data::MEM_SIZE> fast; 
+            MemAllocator<PRECISE, Data::MEM_SIZE> precise; 
+
+            pair<bool, int> r = aligned_alloc(fast); 
+            if(!r.first) 
+                return r; 
+
+            if(!(r = aligned_alloc(precise)).first) 
+                return { false, r.second + 10 }; 
+
+            // a bigger ALIGNMENT holds for every plain alloc
+            MemAllocator<PRECISE, Data::MEM_SIZE, 64> wide; 
+            for(int i = 1; i < 1000; i++) 
+                if((uintptr_t)wide.mem_alloc(i) % 64) 
+                    return { false, 20 }; 
+
+            return { true, -1 }; 
+        }
+
+        // whatever the kernel gives us, the heap has to work and never claim more than was asked for
+        pair<bool, int> page_options() {
+            for(Pages p : { SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGE_PAGES }) 
+                for(bool prefault : { false, true }) {
+                    MemAllocator<FAST, Data::MEM_SIZE> mem({ p, prefault, 0 }); 
+
+                    if(mem.page_mode() > p || mem.prefaulted() != prefault) 
+                        return { false, 0 }; 
+
+                    // prefaulting commits everything up front
+                    if(prefault && mem.arena.committed < Data::MEM_SIZE) 
+                        return { false, 1 }; 
+
+                    char *x = (char*)mem.mem_alloc(Data::MEM_SIZE / 2); 
+                    if(!x) 
+                        return { false, 2 }; 
+
+                    memset(x, 1, Data::MEM_SIZE / 2); 
+                }
+
+            return { true, -1 }; 
+        }
+
+        // live sums have to match what the heap says about its blocks, on every preset
+        template<typename A> 
+        pair<bool, int> stats_counters(A &mem) {
+            const auto live = [](const MemStats &s, size_t &count, size_t &bytes) {
+                count = bytes = 0; 
+                for(const MemStats::Class &c : s.classes) {
+                    count += c.liveCount; 
+                    bytes += c.liveBytes; 
+                }
+            }; 
+
+            vector<char*> v; 
+            size_t usable = 0, count, bytes; 
+
+            for(int i = 0; i < 1000; i++) {
+                v.push_back((char*)mem.mem_alloc(ran(1, 512))); 
+                usable += mem.mem_usable_size(v.back()); 
+            }
+
+            MemStats s = mem.stats(); 
+            live(s, count, bytes); 
+
+            if(!s.tracked || s.allocs != 1000 || count != 1000 || bytes != usable) 
+                return { false, 0 }; 
+
+            if(s.highWater != mem.mem_used() || s.used != mem.mem_used() || s.reserved != Data::MEM_SIZE) 
+                return { false, 1 }; 
+
+            for(size_t i = 0; i < v.size(); i += 2) {
+                usable -= mem.mem_usable_size(v[i]); 
+                mem.mem_free(v[i]); 
+            }
+
+            if(mem.mem_alloc(SIZE_MAX / 2)) 
+                return { false, 2 }; 
+
+            s = mem.stats(); 
+            live(s, count, bytes); 
+
+            if(s.frees != 500 || s.failedAllocs != 1 || count != 500 || bytes != usable) 
+                return { false, 3 }; 
+
+            for(size_t i = 1; i < v.size(); i += 2) 
+                mem.mem_free(v[i]); 
+
+            live(mem.stats(), count, bytes); 
+            if(count || bytes) 
+                return { false, 4 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> stats_counters() {
+            using Precise = MemAllocator<PRECISE, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats>; 
+            using Tlsf = MemAllocator<TLSF, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats>; 
+            using Slab = MemAllocator<SLAB, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats>; 
+
+            Tracked fast; 
+            unique_ptr<Precise> precise(new Precise()); 
+            unique_ptr<Tlsf> tlsf(new Tlsf()); 
+            unique_ptr<Slab> slab(new Slab()); 
+
+            pair<bool, int> r; 
+            if(!(r = stats_counters(fast)).first) 
+                return r; 
+
+            if(!(r = stats_counters(*precise)).first) 
+                return { false, r.second + 10 }; 
+
+            if(!(r = stats_counters(*tlsf)).first) 
+                return { false, r.second + 20 }; 
+
+            if(!(r = stats_counters(*slab)).first) 
+                return { false, r.second + 30 }; 
+
+            // freeing every second block and then the rest has to have merged something
+            if(!precise->stats().coalesces) 
+                return { false, 40 }; 
+
+            // without TrackStats only the heap itself is reported
+            MemAllocator<FAST, Data::MEM_SIZE> plain; 
+            plain.mem_alloc(100); 
+
+            const MemStats s = plain.stats(); 
+            if(s.tracked || s.allocs || s.used != plain.mem_used()) 
+                return { false, 41 }; 
+
+            return { true, -1 }; 
+        }
+
+        // the walk has to see every block in address order, and the report has to add up to mem_used()
+        template<typename A> 
+        pair<bool, int> heap_walk(A &mem) {
+            vector<char*> v; 
+            size_t live = 0, freed = 0; 
+
+            for(int i = 0; i < 1000; i++) 
+                v.push_back((char*)mem.mem_alloc(ran(1, 2048))); 
+
+            // every third block, so PRECISE and TLSF have nothing to merge
+            for(size_t i = 0; i < v.size(); i++) {
+                if(i % 3 == 1) {
+                    freed += mem.mem_usable_size(v[i]); 
+                    mem.mem_free(v[i]); 
+                    v[i] = nullptr; 
+                }
+                else 
+                    live += mem.mem_usable_size(v[i]); 
+            }
+
+            size_t i = 0, blocks = 0; 
+            const void *last = nullptr; 
+
+            for(const HeapBlock &bl : mem.walk()) {
+                if(bl.ptr <= last) 
+                    return { false, 0 }; 
+
+                if(!bl.free && bl.ptr != v[i]) 
+                    return { false, 1 }; 
+
+                last = bl.ptr; 
+                blocks++; 
+                i++; 
+            }
+
+            if(blocks != v.size()) 
+                return { false, 2 }; 
+
+            const MemReport r = mem.report(); 
+            if(r.used != mem.mem_used() || r.liveBytes != live || r.freeBytes != freed || r.blocks != blocks) 
+                return { false, 3 }; 
+
+            size_t count = 0, bytes = 0; 
+            for(uint8_t b = 0; b < MemReport::BUCKET_NUM; b++) {
+                count += r.freeCount[b]; 
+                bytes += r.freeSize[b]; 
+            }
+
+            if(count != v.size() / 3 || bytes != freed || r.largestFree > freed || r.largest_alloc() < r.headroom - 64) 
+                return { false, 4 }; 
+
+            if(r.fragmentation() <= 0 || r.fragmentation() >= 1) 
+                return { false, 5 }; 
+
+            const string json = r.json(); 
+            if(json.front() != '{' || json.back() != '}' || json.find("\"classes\":[{") == string::npos) 
+                return { false, 6 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> heap_walk() {
+            MemAllocator<FAST, Data::MEM_SIZE> fast; 
+            unique_ptr<MemAllocator<PRECISE, Data::MEM_SIZE>> precise(new MemAllocator<PRECISE, Data::MEM_SIZE>()); 
+            unique_ptr<MemAllocator<TLSF, Data::MEM_SIZE>> tlsf(new MemAllocator<TLSF, Data::MEM_SIZE>()); 
+
+            pair<bool, int> r; 
+            if(!(r = heap_walk(fast)).first) 
+                return r; 
+
+            if(!(r = heap_walk(*precise)).first) 
+                return { false, r.second + 10 }; 
+
+            if(!(r = heap_walk(*tlsf)).first) 
+                return { false, r.second + 20 }; 
+
+            // FAST leaves neighbours as they are, two free blocks side by side are one run
+            MemAllocator<FAST, Data::MEM_SIZE> neighbours; 
+            char *x = (char*)neighbours.mem_alloc(100), 
+                 *y = (char*)neighbours.mem_alloc(100); 
+            const size_t run = neighbours.mem_usable_size(x) + FAST_BLOCK_SIZE + neighbours.mem_usable_size(y); 
+
+            neighbours.mem_alloc(100); 
+            neighbours.mem_free(x); 
+            neighbours.mem_free(y); 
+
+            if(neighbours.report().largestRun != run) 
+                return { false, 30 }; 
+
+            return { true, -1 }; 
+        }
+
+        // blocks from largeSize up get their own mapping, outside the arena
+        template<typename A> 
+        pair<bool, int> large_blocks(A &mem) {
+            const size_t size = 2*1024*1024; 
+            char *base = (char*)mem.arena.base(); 
+
+            char *x = (char*)mem.mem_alloc(size); 
+            if(!x || (x >= base && x < base + Data::MEM_SIZE)) 
+                return { false, 0 }; 
+
+            memset(x, 1, size); 
+            const size_t used = mem.mem_used(); 
+
+            if(mem.mem_usable_size(x) < size || mem.stats().largeBlocks != 1 || mem.stats().largeBytes < size) 
+                return { false, 1 }; 
+
+            // growing moves the pages, the heap stays as it is
+            x = (char*)mem.mem_realloc(x, 2 * size); 
+            if(!x || x[size - 1] != 1 || mem.mem_usable_size(x) < 2 * size || mem.mem_used() != used) 
+                return { false, 2 }; 
+
+            if(!mem.mem_free(x) || mem.stats().largeBlocks != 0 || mem.stats().largeBytes != 0) 
+                return { false, 3 }; 
+
+            // blocks from the arena move out once they reach largeSize
+            char *y = (char*)mem.mem_alloc(1000); 
+            memset(y, 2, 1000); 
+            y = (char*)mem.mem_realloc(y, size); 
+            if(!y || (y >= base && y < base + Data::MEM_SIZE) || y[999] != 2 || mem.stats().largeBlocks != 1) 
+                return { false, 4 }; 
+
+            mem.mem_free(y); 
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> large_blocks() {
+            MemAllocator<FAST, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats> fast; 
+            unique_ptr<MemAllocator<PRECISE, Data::MEM_SIZE>> precise(new MemAllocator<PRECISE, Data::MEM_SIZE>()); 
+
+            pair<bool, int> r; 
+            if(!(r = large_blocks(fast)).first) 
+                return r; 
+
+            if(!(r = large_blocks(*precise)).first) 
+                return { false, r.second + 10 }; 
+
+            // 0 turns the path off
+            MemAllocator<FAST, Data::MEM_SIZE> off({ SMALL_PAGES, false, 0 }); 
+            char *x = (char*)off.mem_alloc(2*1024*1024); 
+            if(!x || x < (char*)off.arena.base() || off.stats().largeBlocks) 
+                return { false, 20 }; 
+
+            return { true, -1 }; 
+        }
+
+        // 8 byte headers, the same arena holds more small blocks and everything else works as before
+        pair<bool, int> compact_headers() {
+            using Fast = MemAllocator<FAST, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats, CompactHeader>; 
+            using Precise = MemAllocator<PRECISE, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats, CompactHeader>; 
+
+            if(sizeof(Fast::Block) != 8 || sizeof(Precise::Block) != 8) 
+                return { false, 0 }; 
+
+            // the walks expect an empty heap
+            pair<bool, int> r; 
+            if(!(r = stats_counters(*unique_ptr<Fast>(new Fast()))).first) 
+                return { false, r.second + 10 }; 
+
+            if(!(r = heap_walk(*unique_ptr<Fast>(new Fast()))).first) 
+                return { false, r.second + 20 }; 
+
+            if(!(r = stats_counters(*unique_ptr<Precise>(new Precise()))).first) 
+                return { false, r.second + 30 }; 
+
+            if(!(r = heap_walk(*unique_ptr<Precise>(new Precise()))).first) 
+                return { false, r.second + 40 }; 
+
+            // 24b objects: 16 + 24 rounds up to 48 with a wide header, 8 + 24 is exactly 32
+            MemAllocator<FAST, Data::MEM_SIZE> wide; 
+            Fast compact; 
+            size_t wideAmnt = 0, compactAmnt = 0; 
+
+            while(wide.mem_alloc(24)) 
+                wideAmnt++; 
+
+            while(compact.mem_alloc(24)) 
+                compactAmnt++; 
+
+            if(compactAmnt * 2 < wideAmnt * 3 - 3) 
+                return { false, 50 }; 
+
+            return { true, -1 }; 
+        }
+
+        // frees wait in the cache unmerged, a hit hands back the same block, a miss or compact() merges them all
+        pair<bool, int> deferred_coalescing() {
+            MemOptions opts; 
+            opts.deferCoalescing = true; 
+            unique_ptr<MemAllocator<PRECISE, Data::MEM_SIZE>> mem(new MemAllocator<PRECISE, Data::MEM_SIZE>(opts)); 
+
+            char *a = (char*)mem->mem_alloc(64), 
+                 *b = (char*)mem->mem_alloc(64), 
+                 *c = (char*)mem->mem_alloc(64), 
+                 *d = (char*)mem->mem_alloc(64); // keeps a-c off the top
+
+            mem->mem_free(b); 
+            if(mem->mem_alloc(64) != b || !precise_tags(*mem)) 
+                return { false, 0 }; 
+
+            // the walk sees three free blocks next to each other, none of them merged yet
+            mem->mem_free(a); 
+            mem->mem_free(b); 
+            mem->mem_free(c); 
+            const MemReport r = mem->report(); 
+            if(r.freeBytes != 3 * 64 || r.largestFree != 64 || !precise_tags(*mem)) 
+                return { false, 1 }; 
+
+            // nothing cached fits 200b, the miss merges a-c into one block and takes it
+            if(mem->mem_alloc(200) != a || mem->report().freeBytes || mem->compact()) 
+                return { false, 2 }; 
+
+            mem->mem_free(a); 
+            mem->mem_free(d); 
+
+            const pair<bool, int> churn = precise_coalescing(*mem); 
+            if(!churn.first) 
+                return { false, churn.second + 10 }; 
+
+            // the same churn again, merged in idle time every few thousand ops
+            mt19937 gen(9); 
+            vector<void*> v; 
+
+            for(int i = 0; i < 200'000; i++) {
+                if(i % 5000 == 0) 
+                    mem->compact(); 
+
+                if(v.empty() || gen() % 2) {
+                    v.push_back(mem->mem_alloc(gen() % 512 + 1)); 
+                    continue; 
+                }
+
+                const size_t idx = gen() % v.size(); 
+                mem->mem_free(v[idx]); 
+                v[idx] = v.back(); 
+                v.pop_back(); 
+            }
+
+            for(void *x : v) 
+                mem->mem_free(x); 
+
+            if(!mem->compact() || mem->offset != mem->FIRST_BLOCK || !precise_tags(*mem)) 
+                return { false, 20 }; 
+
+            return { true, -1 }; 
+        }
+
+        // a free top moves offset back on its own, mem_trim hands the free pages back and leaves the live blocks alone. 
+        // with a trimThreshold mem_free does the same for the top once enough piled up
+        template<typename A> 
+        pair<bool, int> trim_pages() {
+            const size_t size = 64*1024, 
+                         amnt = 64; 
+            unique_ptr<A> mem(new A()); 
+            vector<char*> v; 
+
+            for(size_t i = 0; i < amnt; i++) {
+                v.push_back((char*)mem->mem_alloc(size)); 
+                memset(v.back(), (int)i, size); 
+            }
+
+            const size_t before = mem->stats().resident; 
+            if(before < amnt * size) 
+                return { false, 0 }; 
+
+            // the top half goes back to the bump region, the lower half turns into free blocks
+            for(size_t i = amnt - 1; i > amnt / 2; i--) 
+                mem->mem_free(v[i]); 
+
+            for(size_t i = 1; i < amnt / 2; i++) 
+                mem->mem_free(v[i]); 
+
+            if(mem->mem_used() != (size_t)(v[amnt / 2] + size - (char*)mem->memory)) 
+                return { false, 1 }; 
+
+            const size_t bytes = mem->mem_trim(); 
+            const size_t after = mem->stats().resident;
+
+            // every free block keeps its first and last page at most
+            if(!bytes || after > before - (amnt - 2) * (size - 2 * 4096)) 
+                return { false, 2 }; 
+
+            if(v[0][size - 1] != 0 || v[amnt / 2][0] != (char)(amnt / 2) || v[amnt / 2][size - 1] != (char)(amnt / 2)) 
+                return { false, 3 }; 
+
+            // the released pages work as before
+            char *x = (char*)mem->mem_alloc(size); 
+            if(x != v[1] && x != v[amnt / 2 - 1]) 
+                return { false, 4 }; 
+
+            memset(x, 1, size); 
+
+            MemOptions opts; 
+            opts.trimThreshold = 1024*1024; 
+            unique_ptr<A> trimmed(new A(opts)); 
+
+            v.clear(); 
+            for(size_t i = 0; i < amnt; i++) {
+                v.push_back((char*)trimmed->mem_alloc(size)); 
+                memset(v.back(), 1, size); 
+            }
+
+            for(size_t i = amnt; i-- > 0;) 
+                trimmed->mem_free(v[i]); 
+
+            if(trimmed->mem_used() != trimmed->FIRST_BLOCK || trimmed->stats().resident > opts.trimThreshold + size) 
+                return { false, 5 }; 
+
+            // a batch at the top rolls back the same way
+            void *batch[amnt]; 
+            if(trimmed->mem_alloc_batch(size, amnt, batch) != amnt) 
+                return { false, 6 }; 
+
+            for(size_t i = 0; i < amnt; i++) 
+                memset(batch[i], 1, size); 
+
+            if(trimmed->mem_free_batch(batch, amnt) != amnt || trimmed->mem_used() != trimmed->FIRST_BLOCK || 
+               trimmed->stats().resident > opts.trimThreshold + size) 
+                return { false, 7 }; 
+
+            return { true, -1 }; 
+        }
+
+        pair<bool, int> trim_pages() {
+            pair<bool, int> r; 
+            if(!(r = trim_pages<MemAllocator<FAST, Data::MEM_SIZE>>()).first) 
+                return r; 
+
+            if(!(r = trim_pages<MemAllocator<PRECISE, Data::MEM_SIZE>>()).first) 
+                return { false, r.second + 10 }; 
+
+            return { true, -1 }; 
+        }
+
         //pair<bool, int> max_alloc_and_split() {}
         
 
@@ -235,7 +1043,7 @@ class AllocAndFree {
             - complete max_alloc_and_free()
 
             - max_alloc_and_split... 
-            - add seeds to randomizer
+            - add seeds to randomizer X
             - cleanup code 
         */
 
@@ -0,0 +1,122 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <cstring>
+
+using namespace std;
+
+class BumpArenas {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<BUMP, Data::MEM_SIZE>;
+
+        // blocks lie back to back without headers, nested markers drop exactly their own blocks
+        pair<bool, int> mark_and_rewind() {
+            Alloc mem;
+            char *a = (char*)mem.mem_alloc(16),
+                 *b = (char*)mem.mem_alloc(5);
+
+            if(b != a + 16 || (uintptr_t)b % alignof(std::max_align_t) || mem.mem_used() != 32)
+                return { false, 0 };
+
+            const Alloc::Marker outer = mem.mark();
+            char *c = (char*)mem.mem_alloc(100);
+
+            const Alloc::Marker inner = mem.mark();
+            mem.mem_alloc(1000);
+            mem.mem_alloc(1000);
+
+            if(!mem.rewind(inner) || mem.mem_used() != inner.offset || mem.mem_alloc(100) != (char*)mem.memory + inner.offset)
+                return { false, 1 };
+
+            // inner lies past the arena once its back at outer
+            if(!mem.rewind(outer) || mem.rewind(inner))
+                return { false, 2 };
+
+            if(mem.mem_alloc(100) != c)
+                return { false, 3 };
+
+            // only the latest block goes back on its own
+            char *d = (char*)mem.mem_alloc(64);
+            if(!mem.mem_free(c) || mem.mem_used() != (size_t)(d + 64 - (char*)mem.memory))
+                return { false, 4 };
+
+            if(!mem.mem_free(d) || mem.mem_used() != (size_t)(d - (char*)mem.memory) || mem.mem_free(d))
+                return { false, 5 };
+
+            char *e = (char*)mem.mem_alloc_aligned(10, 4096);
+            if(!e || (uintptr_t)e % 4096)
+                return { false, 6 };
+
+            mem.reset();
+            if(mem.mem_used() || mem.mem_alloc(8) != a)
+                return { false, 7 };
+
+            return { true, -1 };
+        }
+
+        // a 0 byte block still gets an address of its own, freeing it leaves the block after it alone
+        pair<bool, int> zero_size() {
+            Alloc mem;
+            char *a = (char*)mem.mem_alloc(0),
+                 *b = (char*)mem.mem_alloc(8);
+
+            if(!a || a == b)
+                return { false, 0 };
+
+            memset(b, 1, 8);
+            const size_t used = mem.mem_used();
+
+            if(!mem.mem_free(a) || mem.mem_used() != used || mem.mem_alloc(8) == b || b[7] != 1)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // running out fails cleanly, a reset makes the whole arena usable again
+        pair<bool, int> fill_and_reset() {
+            Alloc mem;
+
+            for(int round = 0; round < 3; round++) {
+                size_t amnt = 0;
+                while(mem.mem_alloc(1024))
+                    amnt++;
+
+                if(amnt != Data::MEM_SIZE / 1024 || mem.mem_alloc(1) || mem.mem_alloc(SIZE_MAX))
+                    return { false, round };
+
+                mem.reset();
+            }
+
+            return { true, -1 };
+        }
+
+        // reset with keep drops the pages behind it, they come back as zeros. the pages in front stay as they were
+        pair<bool, int> release_tail() {
+            Alloc mem;
+            const size_t keep = 1024*1024,
+                         size = 8*1024*1024;
+
+            char *x = (char*)mem.mem_alloc(size);
+            memset(x, 1, size);
+            mem.reset(keep);
+
+            x = (char*)mem.mem_alloc(size);
+            if(x[0] != 1 || x[keep - 1] != 1)
+                return { false, 0 };
+
+            for(size_t i = keep; i < size; i += 4096)
+                if(x[i])
+                    return { false, 1 };
+
+            // below the high water mark nothing more gets released
+            memset(x, 2, keep);
+            mem.reset(4 * keep);
+            if(x[0] != 2)
+                return { false, 2 };
+
+            return { true, -1 };
+        }
+};
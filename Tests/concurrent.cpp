@@ -0,0 +1,148 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <memory>
+#include <cstring>
+
+using namespace std;
+
+class ConcurrentHeap {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<CONCURRENT, Data::MEM_SIZE>;
+
+        static constexpr    int     THREAD_AMNT     = 8,
+                                    OP_AMNT         = 200'000,
+                                    MAILBOX_AMNT    = 64;
+
+        // every size lands in a class thats big enough and at most 25% too big
+        pair<bool, int> size_classes() {
+            for(size_t bytes = 1; bytes < Data::MEM_SIZE; bytes += bytes / 7 + 1) {
+                const size_t c = Alloc::class_of(bytes),
+                             size = Alloc::class_size(c);
+
+                if(size < bytes || (bytes > 8 * alignof(std::max_align_t) && size > bytes + bytes / 4) || size % alignof(std::max_align_t))
+                    return { false, 0 };
+
+                if(c && Alloc::class_size(c - 1) >= bytes)
+                    return { false, 1 };
+            }
+
+            return { true, -1 };
+        }
+
+        // threads alloc, free and hand blocks to each other through mailboxes, so most blocks get freed by another thread.
+        // an owner flag per block start catches an address handed out twice, the stamp at both ends of a block
+        // catches two blocks overlapping
+        pair<bool, int> stress() {
+            unique_ptr<Alloc> mem(new Alloc());
+            unique_ptr<atomic<uint8_t>[]> owned(new atomic<uint8_t>[Data::MEM_SIZE / 8]());
+            atomic<void*> mailbox[MAILBOX_AMNT];
+            atomic<int> errors { 0 };
+            vector<thread> threads;
+
+            for(atomic<void*> &m : mailbox)
+                m = nullptr;
+
+            auto flag = [&](void *x) -> atomic<uint8_t>& { return owned[((char*)x - (char*)mem->memory) / 8]; };
+
+            // [stamp, size, ..., stamp]
+            auto check_and_free = [&](void *x) {
+                uint64_t *head = (uint64_t*)x;
+                uint64_t tail;
+                memcpy(&tail, (char*)x + head[1] - 8, 8);
+
+                if(tail != head[0])
+                    errors++;
+
+                flag(x).store(0);
+                mem->mem_free(x);
+            };
+
+            for(int t = 0; t < THREAD_AMNT; t++)
+                threads.emplace_back([&, t]() {
+                    mt19937 gen(t);
+                    uniform_int_distribution<> sizeDist(24, 512);
+                    vector<void*> live;
+
+                    for(int i = 0; i < OP_AMNT; i++) {
+                        if(live.empty() || gen() % 2) {
+                            const size_t size = sizeDist(gen);
+                            void *x = mem->mem_alloc(size);
+                            if(!x) {
+                                errors++;
+                                return;
+                            }
+
+                            uint8_t expected = 0;
+                            if(!flag(x).compare_exchange_strong(expected, 1))
+                                errors++;
+
+                            const uint64_t stamp = (uint64_t)t << 32 | i;
+                            ((uint64_t*)x)[0] = stamp;
+                            ((uint64_t*)x)[1] = size;
+                            memcpy((char*)x + size - 8, &stamp, 8);
+
+                            live.push_back(x);
+                            continue;
+                        }
+
+                        const size_t idx = gen() % live.size();
+                        void *x = live[idx];
+                        live[idx] = live.back();
+                        live.pop_back();
+
+                        // swap it into a mailbox, whatever was there gets freed here
+                        if(gen() % 2)
+                            x = mailbox[gen() % MAILBOX_AMNT].exchange(x);
+
+                        if(x)
+                            check_and_free(x);
+                    }
+
+                    for(void *x : live)
+                        check_and_free(x);
+                });
+
+            for(thread &t : threads)
+                t.join();
+
+            for(atomic<void*> &m : mailbox)
+                if(void *x = m.load())
+                    check_and_free(x);
+
+            if(errors)
+                return { false, 0 };
+
+            // everything went back, the stacks hold every byte taken from the bump region exactly once
+            size_t bytes = 0;
+            for(size_t c = 0; c < Alloc::CLASS_NUM; c++)
+                for(size_t sh = 0; sh < Alloc::SHARD_NUM; sh++)
+                    for(uint32_t idx = (uint32_t)mem->heads[c][sh].top.load(); idx != Alloc::EMPTY; idx = Alloc::link(mem->block_at(idx))->load())
+                        bytes += Alloc::class_size(c);
+
+            if(bytes != mem->mem_used() - Alloc::FIRST_BLOCK)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // running out fails cleanly and offset never ends up past the arena
+        pair<bool, int> fill() {
+            unique_ptr<Alloc> mem(new Alloc());
+            size_t amnt = 0;
+
+            while(mem->mem_alloc(1000))
+                amnt++;
+
+            if(amnt < Data::MEM_SIZE / 1024 * 9 / 10 || mem->mem_alloc(SIZE_MAX) || mem->mem_used() > Data::MEM_SIZE)
+                return { false, 0 };
+
+            return { true, -1 };
+        }
+};
@@ -0,0 +1,117 @@
+#include <iostream>
+#include "../memPool.h"
+#include <vector>
+#include <random>
+#include <string>
+#include <memory>
+
+using namespace std;
+
+class Pools {
+    private:
+        friend class Tests;
+
+        struct Node {
+            int key;
+            string name;
+            unique_ptr<int> value;
+            static int alive;
+
+            Node(int key, string name, unique_ptr<int> value) : key(key), name(move(name)), value(move(value)) { alive++; }
+            ~Node() { alive--; }
+        };
+
+        struct alignas(64) Line {
+            char bytes[40];
+        };
+
+        // arguments are forwarded as they are, freed slots come back first, a full pool says so
+        pair<bool, int> create_and_destroy() {
+            MemPool<Node, 1000> pool;
+            Node::alive = 0;
+
+            Node *a = pool.create(1, string(100, 'a'), make_unique<int>(7));
+            if(!a || a->key != 1 || a->name.size() != 100 || *a->value != 7 || Node::alive != 1)
+                return { false, 0 };
+
+            pool.destroy(a);
+            Node *b = pool.create(2, "b", nullptr);
+            if(b != a || Node::alive != 1 || pool.size() != 1)
+                return { false, 1 };
+
+            vector<Node*> v { b };
+            while(Node *x = pool.create(3, "", nullptr))
+                v.push_back(x);
+
+            if(v.size() != pool.capacity() || pool.size() != pool.capacity())
+                return { false, 2 };
+
+            for(Node *x : v)
+                pool.destroy(x);
+
+            if(Node::alive || pool.size())
+                return { false, 3 };
+
+            return { true, -1 };
+        }
+
+        // random creates and destroys, every object has to keep its own key and the slots its alignment
+        pair<bool, int> random_churn() {
+            MemPool<Line, 100'000> pool;
+            mt19937 gen(5);
+            vector<Line*> v;
+
+            for(int i = 0; i < 1'000'000; i++) {
+                if(v.empty() || (gen() % 2 && v.size() < pool.capacity())) {
+                    Line *x = pool.create();
+                    if(!x || (uintptr_t)x % 64)
+                        return { false, 0 };
+
+                    memset(x->bytes, (char)(uintptr_t)x, sizeof(x->bytes));
+                    v.push_back(x);
+                    continue;
+                }
+
+                const size_t idx = gen() % v.size();
+                for(char c : v[idx]->bytes)
+                    if(c != (char)(uintptr_t)v[idx])
+                        return { false, 1 };
+
+                pool.destroy(v[idx]);
+                v[idx] = v.back();
+                v.pop_back();
+            }
+
+            return { true, -1 };
+        }
+
+        // clear runs every destructor still due and starts over at the first slot
+        pair<bool, int> clear_all() {
+            MemPool<Node, 10'000> pool;
+            Node::alive = 0;
+
+            vector<Node*> v;
+            for(int i = 0; i < 5000; i++)
+                v.push_back(pool.create(i, to_string(i), make_unique<int>(i)));
+
+            for(int i = 0; i < 5000; i += 3)
+                pool.destroy(v[i]);
+
+            pool.clear();
+            if(Node::alive || pool.size() || pool.create(0, "", nullptr) != v[0])
+                return { false, 0 };
+
+            {
+                MemPool<Node, 100> scoped;
+                scoped.create(1, "", nullptr);
+                scoped.create(2, "", nullptr);
+            }
+
+            if(Node::alive != 1)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+};
+
+int Pools::Node::alive = 0;
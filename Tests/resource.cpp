@@ -0,0 +1,115 @@
+#include <iostream>
+#include "../memResource.h"
+#include "testData.cpp"
+#include <vector>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <random>
+
+using namespace std;
+
+class Adapters {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<FAST, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats>;
+
+        struct alignas(64) Wide {
+            char c[64];
+        };
+
+        inline bool in_heap(const Alloc &mem, const void *ptr) const {
+            return ptr >= mem.memory && ptr < (char*)mem.memory + mem.offset;
+        }
+
+        // pmr containers allocate from the heap and give everything back when they are gone
+        pair<bool, int> pmr_containers() {
+            Alloc mem;
+            MemResource<Alloc> res(mem);
+
+            {
+                pmr::vector<int> v(&res);
+                pmr::map<int, int> m(&res);
+
+                for(int i = 0; i < 10'000; i++) {
+                    v.push_back(i);
+                    m[i] = i * 2;
+                }
+
+                if(!in_heap(mem, v.data()) || !in_heap(mem, &m.begin()->second))
+                    return { false, 0 };
+
+                for(int i = 0; i < 10'000; i++)
+                    if(v[i] != i || m[i] != i * 2)
+                        return { false, 1 };
+
+                // alignment asked for by the container has to hold
+                pmr::vector<Wide> w(100, &res);
+                if((uintptr_t)w.data() % alignof(Wide))
+                    return { false, 2 };
+            }
+
+            if(mem.stats().allocs != mem.stats().frees)
+                return { false, 3 };
+
+            // resources on the same heap are interchangeable, on another heap they are not
+            Alloc other;
+            MemResource<Alloc> same(mem), foreign(other);
+
+            if(!(res == same) || res == foreign)
+                return { false, 4 };
+
+            return { true, -1 };
+        }
+
+        // rebinding, copying and moving keeps the heap, random inserts and erases stay consistent
+        pair<bool, int> stl_allocator() {
+            Alloc mem;
+            MemStlAllocator<int, Alloc> a(mem);
+            mt19937 gen(3);
+
+            list<int, MemStlAllocator<int, Alloc>> l(a);
+            unordered_map<int, int, hash<int>, equal_to<int>, MemStlAllocator<pair<const int, int>, Alloc>> u(0, hash<int>(), equal_to<int>(), a);
+            std::map<int, int> ref;
+
+            for(int i = 0; i < 100'000; i++) {
+                const int k = gen() % 5000;
+
+                if(gen() % 3) {
+                    u[k] = i;
+                    ref[k] = i;
+                    l.push_back(k);
+                }
+                else {
+                    u.erase(k);
+                    ref.erase(k);
+
+                    if(!l.empty())
+                        l.pop_front();
+                }
+            }
+
+            if(u.size() != ref.size())
+                return { false, 0 };
+
+            for(auto &[k, v] : ref)
+                if(u.at(k) != v)
+                    return { false, 1 };
+
+            if(!l.empty() && !in_heap(mem, &l.front()))
+                return { false, 2 };
+
+            list<int, MemStlAllocator<int, Alloc>> moved(std::move(l));
+            if(moved.get_allocator() != a || &moved.get_allocator().heap() != &mem)
+                return { false, 3 };
+
+            MemStlAllocator<Wide, Alloc> wa(a);
+            Wide *w = wa.allocate(10);
+            if((uintptr_t)w % alignof(Wide))
+                return { false, 4 };
+
+            wa.deallocate(w, 10);
+            return { true, -1 };
+        }
+};
@@ -0,0 +1,215 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <random>
+#include <string>
+#include <cstring>
+#include <sys/wait.h>
+
+using namespace std;
+
+class SharedHeap {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<SHARED, Data::MEM_SIZE>;
+
+        static constexpr    int     PROC_AMNT       = 4,
+                                    OP_AMNT         = 50'000,
+                                    MSG_SIZE        = 1024*1024;
+
+        // unique per test run, so a leftover object from a crashed run doesnt get attached to
+        static string name(const char *test) { return "/memAllocTest-" + to_string(getpid()) + "-" + test; }
+
+        // waits for every child, true if all of them exited with 0
+        static bool wait_children(const int amnt) {
+            bool ok = true;
+
+            for(int i = 0; i < amnt; i++) {
+                int status;
+                if(wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status))
+                    ok = false;
+            }
+
+            return ok;
+        }
+
+        // two mappings of one heap in the same process: same blocks at different addresses, either one can free them
+        pair<bool, int> two_mappings() {
+            const string n = name("two");
+            Alloc a(n.c_str());
+            Alloc b(n.c_str());
+
+            if(!a.created() || b.created() || a.memory == b.memory)
+                return { false, 0 };
+
+            char *x = (char*)a.mem_alloc(100),
+                 *y = (char*)a.mem_alloc(200),
+                 *z = (char*)a.mem_alloc(300);
+            strcpy(y, "hello");
+
+            char *by = (char*)b.at(a.offset_of(y));
+            if(strcmp(by, "hello") || b.mem_usable_size(by) < 200 || !b.owns(by))
+                return { false, 1 };
+
+            // y merges with x and z on both sides, the whole run is the top and goes back to the bump region
+            a.mem_free(x);
+            b.mem_free(b.at(a.offset_of(z)));
+            b.mem_free(by);
+
+            if(a.mem_used() != Alloc::FIRST_BLOCK || b.mem_used() != Alloc::FIRST_BLOCK || b.mem_free(by))
+                return { false, 2 };
+
+            Alloc::unlink(n.c_str());
+            return { true, -1 };
+        }
+
+        // processes alloc and free at the same time, each checks its blocks still hold its own pattern.
+        // every child also hands the parent a big block through a pipe, only as an offset
+        pair<bool, int> cross_process() {
+            const string n = name("cross");
+            Alloc mem(n.c_str());
+            int fds[2];
+
+            if(pipe(fds))
+                return { false, 0 };
+
+            for(int p = 0; p < PROC_AMNT; p++) {
+                if(fork())
+                    continue;
+
+                Alloc child(n.c_str());
+                mt19937 gen(p);
+                vector<pair<char*, size_t>> v;
+
+                for(int i = 0; i < OP_AMNT; i++) {
+                    if(v.empty() || gen() % 2) {
+                        const size_t size = gen() % 4096 + 1;
+                        char *x = (char*)child.mem_alloc(size);
+                        if(!x)
+                            _exit(1);
+
+                        memset(x, 'a' + p, size);
+                        v.push_back({ x, size });
+                        continue;
+                    }
+
+                    const size_t idx = gen() % v.size();
+                    for(size_t j = 0; j < v[idx].second; j++)
+                        if(v[idx].first[j] != 'a' + p)
+                            _exit(2);
+
+                    child.mem_free(v[idx].first);
+                    v[idx] = v.back();
+                    v.pop_back();
+                }
+
+                for(auto &x : v)
+                    child.mem_free(x.first);
+
+                char *msg = (char*)child.mem_alloc(MSG_SIZE);
+                memset(msg, 'A' + p, MSG_SIZE);
+
+                const size_t off = child.offset_of(msg);
+                _exit(write(fds[1], &off, sizeof(off)) == sizeof(off) ? 0 : 3);
+            }
+
+            close(fds[1]);
+            const bool childrenOk = wait_children(PROC_AMNT);
+
+            // messages come in any order, the first byte tells whose it is
+            int msgs = 0, seen = 0;
+            size_t off;
+
+            while(read(fds[0], &off, sizeof(off)) == sizeof(off)) {
+                const char *msg = (char*)mem.at(off);
+                const char c = msg[0];
+
+                for(int j = 0; j < MSG_SIZE; j++)
+                    if(msg[j] != c)
+                        return { false, 1 };
+
+                seen |= 1 << (c - 'A');
+                msgs++;
+                mem.mem_free(msg);
+            }
+
+            close(fds[0]);
+            Alloc::unlink(n.c_str());
+
+            if(!childrenOk || msgs != PROC_AMNT || seen != (1 << PROC_AMNT) - 1)
+                return { false, 2 };
+
+            // everything got freed again, by whoever, so the heap is empty
+            if(mem.mem_used() != Alloc::FIRST_BLOCK)
+                return { false, 3 };
+
+            return { true, -1 };
+        }
+
+        // a creator that died before the heap was ready leaves the name behind, attaching gives up instead of hanging
+        pair<bool, int> stale_name() {
+            const string n = name("stale");
+            const int fd = shm_open(n.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if(fd < 0 || ftruncate(fd, Alloc::MAPPING))
+                return { false, 0 };
+
+            close(fd);
+
+            if(!fork()) {
+                // stderr stays quiet, the message is expected
+                freopen("/dev/null", "w", stderr);
+                Alloc mem(n.c_str());
+                _exit(0);
+            }
+
+            int status;
+            const bool gaveUp = (wait(&status) > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 1);
+            Alloc::unlink(n.c_str());
+
+            if(!gaveUp)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // a memfd has no name, the child gets the heap through the fd it inherits
+        pair<bool, int> memfd_heap() {
+            const int fd = memfd_create("memAllocTest", 0);
+            if(fd < 0)
+                return { false, 0 };
+
+            Alloc mem(fd);
+            char *x = (char*)mem.mem_alloc(64);
+            strcpy(x, "parent");
+
+            int fds[2];
+            if(pipe(fds))
+                return { false, 1 };
+
+            if(!fork()) {
+                Alloc child(fd);
+                if(child.created() || strcmp((char*)child.at(mem.offset_of(x)), "parent"))
+                    _exit(1);
+
+                char *y = (char*)child.mem_alloc(64);
+                strcpy(y, "child");
+                child.mem_free(child.at(mem.offset_of(x)));
+
+                const size_t off = child.offset_of(y);
+                _exit(write(fds[1], &off, sizeof(off)) == sizeof(off) ? 0 : 2);
+            }
+
+            close(fds[1]);
+            size_t off = 0;
+            const bool got = (read(fds[0], &off, sizeof(off)) == sizeof(off));
+            close(fds[0]);
+
+            if(!wait_children(1) || !got || strcmp((char*)mem.at(off), "child"))
+                return { false, 2 };
+
+            close(fd);
+            return { true, -1 };
+        }
+};
@@ -0,0 +1,101 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <random>
+#include <cstring>
+
+using namespace std;
+
+class Slabs {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<SLAB, Data::MEM_SIZE>;
+
+        // objects of one class sit right next to each other, no header in between
+        pair<bool, int> headerless_objects() {
+            Alloc mem;
+            char *prev = (char*)mem.mem_alloc(16);
+
+            for(int i = 1; i < 100; i++) {
+                char *x = (char*)mem.mem_alloc(16);
+
+                if(x != prev + 16)
+                    return { false, 0 };
+
+                prev = x;
+            }
+
+            if(Alloc::slab_of(prev)->objSize != 16 || Alloc::slab_of(prev)->used != 100)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // random sizes and frees, every object gets filled with its own pattern which has to survive
+        pair<bool, int> random_alloc_and_free() {
+            Alloc mem;
+            mt19937 gen(11);
+            vector<pair<unsigned char*, size_t>> v;
+
+            for(int i = 0; i < 1'000'000; i++) {
+                if(v.empty() || gen() % 2) {
+                    const size_t size = (gen() % 8 ? gen() % 128 + 1 : gen() % 8192 + 1);
+                    unsigned char *x = (unsigned char*)mem.mem_alloc(size);
+                    if(!x)
+                        return { false, 0 };
+
+                    memset(x, size & 0xff, size);
+                    v.push_back({ x, size });
+                    continue;
+                }
+
+                const size_t idx = gen() % v.size();
+                auto [x, size] = v[idx];
+
+                for(size_t j = 0; j < size; j++)
+                    if(x[j] != (size & 0xff))
+                        return { false, 1 };
+
+                if(!mem.mem_free(x))
+                    return { false, 2 };
+
+                v[idx] = v.back();
+                v.pop_back();
+            }
+
+            for(auto &[x, size] : v)
+                mem.mem_free(x);
+
+            // only one empty slab per class may stay around
+            for(Alloc::Slab *sl : mem.partial)
+                if(sl && (sl->used != 0 || sl->next))
+                    return { false, 3 };
+
+            return { true, -1 };
+        }
+
+        // an emptied slab goes back to the pages and can be used by any other class
+        pair<bool, int> slab_reuse() {
+            Alloc mem;
+            vector<void*> v;
+
+            // two full slabs of 1024b objects and one more in a third
+            for(int i = 0; i < 7; i++)
+                v.push_back(mem.mem_alloc(1024));
+
+            const size_t offset = mem.offset;
+
+            for(int i = 0; i < 3; i++)
+                mem.mem_free(v[i]);
+
+            if(mem.freeRuns != (void*)Alloc::slab_of(v[0]))
+                return { false, 0 };
+
+            if(mem.mem_alloc(8) != (char*)Alloc::slab_of(v[0]) + Alloc::SLAB_HEADER || mem.offset != offset)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+};
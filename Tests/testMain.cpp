@@ -1,11 +1,29 @@
 #include <iostream> 
 #include "allocAndFree.cpp"
+#include "threaded.cpp"
+#include "tlsf.cpp"
+#include "slab.cpp"
+#include "resource.cpp"
+#include "trace.cpp"
+#include "bump.cpp"
+#include "pool.cpp"
+#include "concurrent.cpp"
+#include "shared.cpp"
 
 using namespace std; 
 
 class Tests {
     private: 
         AllocAndFree aaf; 
+        ThreadedHeaps th; 
+        TwoLevel tl; 
+        Slabs sl; 
+        Adapters ad; 
+        Traces tr; 
+        BumpArenas bu; 
+        Pools po; 
+        ConcurrentHeap co; 
+        SharedHeap sh; 
 
         inline void output(pair<bool, int> p) const {
             if(!p.first || p.second > -1) {
@@ -24,6 +42,60 @@ class Tests {
             //output(aaf.invalid_ptr_free());
             //output(aaf.random_type_alloc());
             output(aaf.max_alloc_and_free()); 
+            output(aaf.reserve_and_fill()); 
+            output(aaf.unlink_free_blocks()); 
+            output(aaf.precise_coalescing()); 
+            output(aaf.precise_realloc()); 
+            output(aaf.fast_realloc()); 
+            output(aaf.batch_alloc_and_free()); 
+            output(aaf.aligned_alloc()); 
+            output(aaf.page_options()); 
+            output(aaf.stats_counters()); 
+            output(aaf.heap_walk()); 
+            output(aaf.large_blocks()); 
+            output(aaf.compact_headers()); 
+            output(aaf.deferred_coalescing()); 
+            output(aaf.trim_pages()); 
+
+            output(th.parallel_alloc()); 
+            output(th.remote_free()); 
+            output(th.release_heap()); 
+            output(th.exited_threads()); 
+            output(th.usable_size()); 
+            output(th.aggregate_stats()); 
+            output(th.large_blocks()); 
+
+            output(tl.random_alloc_and_free()); 
+            output(tl.reuse_and_split()); 
+
+            output(sl.headerless_objects()); 
+            output(sl.random_alloc_and_free()); 
+            output(sl.slab_reuse()); 
+
+            output(ad.pmr_containers()); 
+            output(ad.stl_allocator()); 
+
+            output(tr.record_and_read()); 
+            output(tr.deterministic_replay()); 
+            output(tr.threaded_record()); 
+
+            output(bu.mark_and_rewind()); 
+            output(bu.zero_size()); 
+            output(bu.fill_and_reset()); 
+            output(bu.release_tail()); 
+
+            output(po.create_and_destroy()); 
+            output(po.random_churn()); 
+            output(po.clear_all()); 
+
+            output(co.size_classes()); 
+            output(co.stress()); 
+            output(co.fill()); 
+
+            output(sh.two_mappings()); 
+            output(sh.cross_process()); 
+            output(sh.memfd_heap()); 
+            output(sh.stale_name()); 
             
 
         }
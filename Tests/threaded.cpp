@@ -0,0 +1,214 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <set>
+#include <thread>
+#include <random>
+
+using namespace std;
+
+class ThreadedHeaps {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<THREADED, Data::MEM_SIZE>;
+
+        static constexpr    int     THREAD_AMNT     = 8,
+                                    ALLOC_AMNT      = 1'000;
+
+        // every thread allocates at the same time, no address may show up twice
+        pair<bool, int> parallel_alloc() {
+            Alloc mem;
+            vector<vector<char*>> v(THREAD_AMNT);
+            vector<thread> threads;
+
+            for(int t = 0; t < THREAD_AMNT; t++)
+                threads.emplace_back([&mem, &v, t]() {
+                    mt19937 gen(t);
+                    uniform_int_distribution<> dist(1, 256);
+
+                    for(int i = 0; i < ALLOC_AMNT; i++)
+                        v[t].push_back((char*)mem.mem_alloc(dist(gen)));
+                });
+
+            for(thread &t : threads)
+                t.join();
+
+            set<char*> s;
+            for(vector<char*> &tv : v) {
+                for(char *x : tv) {
+                    if(!x)
+                        return { false, 0 };
+
+                    if(s.find(x) != s.end())
+                        return { false, 1 };
+
+                    s.insert(x);
+                }
+            }
+
+            return { true, -1 };
+        }
+
+        // blocks freed by another thread have to come back to the owner
+        pair<bool, int> remote_free() {
+            Alloc mem;
+            vector<char*> v;
+
+            for(int i = 0; i < ALLOC_AMNT; i++)
+                v.push_back((char*)mem.mem_alloc(sizeof(size_t)));
+
+            thread t([&mem, &v]() {
+                for(char *x : v)
+                    if(!mem.mem_free(x))
+                        return;
+            });
+            t.join();
+
+            if(!mem.thread_slot()->remoteFree.load())
+                return { false, 0 };
+
+            // the same amount of allocs must be served from the drained blocks only
+            const size_t offset = mem.heap_of(*mem.thread_slot())->offset;
+            for(int i = 0; i < ALLOC_AMNT; i++)
+                mem.mem_alloc(sizeof(size_t));
+
+            if(mem.heap_of(*mem.thread_slot())->offset != offset)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // every block knows its size, from any thread, foreign pointers have none
+        pair<bool, int> usable_size() {
+            Alloc mem;
+            vector<pair<char*, size_t>> v;
+
+            for(size_t size = 1; size < 4096; size += 37)
+                v.push_back({ (char*)mem.mem_alloc(size), size });
+
+            bool ok = true;
+            thread t([&]() {
+                for(auto &[x, size] : v)
+                    if(mem.mem_usable_size(x) < size)
+                        ok = false;
+            });
+            t.join();
+
+            if(!ok)
+                return { false, 0 };
+
+            // a page outside every heap. it has no object size the compiler knows, so the header read it cant rule out doesnt warn
+            char *foreign = (char*)mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            const bool known = mem.mem_usable_size(foreign) || mem.mem_usable_size(nullptr);
+            munmap(foreign, 4096);
+
+            if(known)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // a released heap gets picked up by the next thread, including its free blocks
+        pair<bool, int> release_heap() {
+            Alloc mem;
+            char *a = nullptr,
+                 *b = nullptr;
+
+            thread t1([&mem, &a]() {
+                a = (char*)mem.mem_alloc(sizeof(size_t));
+                mem.mem_free(a);
+                mem.release_thread_heap();
+            });
+            t1.join();
+
+            thread t2([&mem, &b]() {
+                b = (char*)mem.mem_alloc(sizeof(size_t));
+            });
+            t2.join();
+
+            if(!a || a != b)
+                return { false, 0 };
+
+            return { true, -1 };
+        }
+
+        // threads that exit give their heap back on their own. each one gets a stack of its own, 
+        // otherwise the next thread reuses the stack of the last and with it its id
+        pair<bool, int> exited_threads() {
+            Alloc mem;
+            const int amnt = 100;
+            const size_t stackSize = 256*1024;
+            vector<char> stacks(amnt * stackSize);
+            int failed = 0;
+
+            for(int t = 0; t < amnt; t++) {
+                pthread_attr_t attr;
+                pthread_t thread;
+
+                pthread_attr_init(&attr);
+                pthread_attr_setstack(&attr, &stacks[t * stackSize], stackSize);
+
+                auto work = [](void *arg) -> void* {
+                    auto *c = (pair<Alloc*, int*>*)arg;
+                    if(!c->first->mem_alloc(64))
+                        (*c->second)++;
+
+                    return nullptr;
+                };
+
+                pair<Alloc*, int*> c { &mem, &failed };
+                if(pthread_create(&thread, &attr, work, &c))
+                    return { false, 0 };
+
+                pthread_join(thread, nullptr);
+                pthread_attr_destroy(&attr);
+            }
+
+            if(failed)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // stats() sums up the heap of every thread
+        pair<bool, int> aggregate_stats() {
+            MemAllocator<THREADED, Data::MEM_SIZE, alignof(std::max_align_t), TrackStats> mem;
+            vector<thread> threads;
+
+            for(int t = 0; t < THREAD_AMNT; t++)
+                threads.emplace_back([&mem]() {
+                    for(int i = 0; i < ALLOC_AMNT; i++)
+                        mem.mem_alloc(64);
+                });
+
+            for(thread &t : threads)
+                t.join();
+
+            const MemStats s = mem.stats();
+            if(!s.tracked || s.allocs != THREAD_AMNT * ALLOC_AMNT || s.used != mem.mem_used() || s.reserved != Data::MEM_SIZE)
+                return { false, 0 };
+
+            return { true, -1 };
+        }
+
+        // large blocks belong to no heap, any thread can free them
+        pair<bool, int> large_blocks() {
+            MemAllocator<THREADED, Data::MEM_SIZE> mem;
+            char *x = (char*)mem.mem_alloc(2*1024*1024);
+            if(!x || mem.owns(x) || mem.stats().largeBlocks != 1)
+                return { false, 0 };
+
+            bool freed = false;
+            thread t([&mem, &freed, x]() {
+                freed = mem.mem_free(x);
+            });
+            t.join();
+
+            if(!freed || mem.stats().largeBlocks != 0 || mem.mem_usable_size(x))
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+};
@@ -0,0 +1,106 @@
+#include <iostream>
+#include "../memAlloc.h"
+#include "testData.cpp"
+#include <vector>
+#include <random>
+#include <cstring>
+
+using namespace std;
+
+class TwoLevel {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<TLSF, Data::MEM_SIZE>;
+
+        static constexpr    int     OP_AMNT     = 1'000'000;
+
+        // every non empty list has its bits set, every block sits in the list its size maps to
+        bool lists_consistent(Alloc &mem) const {
+            for(uint8_t fl = 0; fl < Alloc::FL_NUM; fl++) {
+                if(((mem.flBitmap >> fl) & 1) != (mem.slBitmap[fl] != 0))
+                    return false;
+
+                for(uint8_t sl = 0; sl < Alloc::SL_NUM; sl++) {
+                    if(((mem.slBitmap[fl] >> sl) & 1) != (mem.freeLists[fl][sl] != nullptr))
+                        return false;
+
+                    for(Alloc::Block *bl = mem.freeLists[fl][sl]; bl; bl = Alloc::links(bl)->next) {
+                        uint8_t f, s;
+                        Alloc::mapping(Alloc::block_size(bl), f, s);
+
+                        if(f != fl || s != sl || !(bl->size & Alloc::FREE))
+                            return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // random sizes and frees, every block gets filled with its own pattern which has to survive
+        pair<bool, int> random_alloc_and_free() {
+            Alloc mem;
+            mt19937 gen(42);
+            uniform_int_distribution<> sizeDist(1, 4096);
+            vector<pair<unsigned char*, size_t>> v;
+
+            for(int i = 0; i < OP_AMNT; i++) {
+                if(v.empty() || gen() % 2) {
+                    const size_t size = sizeDist(gen);
+                    unsigned char *x = (unsigned char*)mem.mem_alloc(size);
+                    if(!x)
+                        return { false, 0 };
+
+                    memset(x, size & 0xff, size);
+                    v.push_back({ x, size });
+                    continue;
+                }
+
+                const size_t idx = gen() % v.size();
+                auto [x, size] = v[idx];
+
+                for(size_t j = 0; j < size; j++)
+                    if(x[j] != (size & 0xff))
+                        return { false, 1 };
+
+                if(!mem.mem_free(x))
+                    return { false, 2 };
+
+                v[idx] = v.back();
+                v.pop_back();
+            }
+
+            if(!lists_consistent(mem))
+                return { false, 3 };
+
+            // freeing everything has to merge it all back into the bump region
+            for(auto &[x, size] : v)
+                mem.mem_free(x);
+
+            if(mem.offset != 0 || mem.flBitmap != 0)
+                return { false, 4 };
+
+            return { true, -1 };
+        }
+
+        // a freed block between two used ones gets split for a smaller request
+        pair<bool, int> reuse_and_split() {
+            Alloc mem;
+
+            void *a = mem.mem_alloc(1024),
+                 *b = mem.mem_alloc(2048),
+                 *c = mem.mem_alloc(1024);
+
+            mem.mem_free(b);
+            const size_t offset = mem.offset;
+
+            if(mem.mem_alloc(512) != b || mem.mem_alloc(1024) == nullptr || mem.offset != offset)
+                return { false, 0 };
+
+            if(!a || !c || !lists_consistent(mem))
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+};
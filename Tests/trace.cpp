@@ -0,0 +1,190 @@
+#include <iostream>
+#include "../memTrace.h"
+#include "testData.cpp"
+#include <vector>
+#include <tuple>
+#include <random>
+#include <cstdio>
+#include <thread>
+#include <unordered_set>
+
+using namespace std;
+
+class Traces {
+    private:
+        friend class Tests;
+
+        using Alloc = MemAllocator<FAST, Data::MEM_SIZE>;
+
+        static constexpr    int     OP_AMNT     = 100'000;
+
+        FILE *file = nullptr;
+        vector<tuple<TraceOp, size_t, void*, void*>> expected;
+        size_t peakUsed = 0;
+
+        // random allocs, frees and reallocs through the tracer, remembering what should end up in the file
+        void record() {
+            Alloc mem;
+            mt19937 gen(5);
+            vector<void*> v;
+
+            file = tmpfile();
+            MemTracer<Alloc> t(mem, file);
+
+            for(int i = 0; i < OP_AMNT; i++) {
+                const size_t size = gen() % 2048 + 1;
+
+                if(v.empty() || gen() % 2) {
+                    v.push_back(t.mem_alloc(size));
+                    expected.push_back({ TRACE_ALLOC, size, v.back(), nullptr });
+                }
+                else {
+                    void *&x = v[gen() % v.size()];
+
+                    if(gen() % 4) {
+                        t.mem_free(x);
+                        expected.push_back({ TRACE_FREE, 0, x, nullptr });
+                        x = v.back();
+                        v.pop_back();
+                    }
+                    else {
+                        void *old = x;
+                        x = t.mem_realloc(x, size);
+                        expected.push_back({ TRACE_REALLOC, size, old, x });
+                    }
+                }
+
+                if(mem.mem_used() > peakUsed)
+                    peakUsed = mem.mem_used();
+            }
+
+            // realloc to size 0 is a free, only recorded for a block the heap owns
+            void *x = t.mem_alloc(64);
+            expected.push_back({ TRACE_ALLOC, 64, x, nullptr });
+
+            if(mem.mem_used() > peakUsed)
+                peakUsed = mem.mem_used();
+
+            t.mem_realloc(x, 0);
+            expected.push_back({ TRACE_FREE, 0, x, nullptr });
+
+            void *foreign = mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            t.mem_realloc(foreign, 0);
+            munmap(foreign, 4096);
+        }
+
+        // every call comes back out of the file, in order
+        pair<bool, int> record_and_read() {
+            record();
+            rewind(file);
+
+            TraceReader reader(file);
+            if(!reader.valid)
+                return { false, 0 };
+
+            TraceReader::Record r;
+            for(auto &[op, size, id, newId] : expected) {
+                if(!reader.next(r))
+                    return { false, 1 };
+
+                if(r.op != op || r.size != size || r.id != (uintptr_t)id || r.newId != (uintptr_t)newId)
+                    return { false, 2 };
+            }
+
+            if(reader.next(r))
+                return { false, 3 };
+
+            return { true, -1 };
+        }
+
+        // replaying on the same heap configuration takes the exact same path, so it peaks at the same offset
+        pair<bool, int> deterministic_replay() {
+            if(!file)
+                record();
+
+            ReplayStats stats;
+            if(!TraceReplay<Alloc>::run(file, stats))
+                return { false, 0 };
+
+            if(stats.ops != expected.size() || stats.failed != 0 || stats.peakUsed != peakUsed)
+                return { false, 1 };
+
+            return { true, -1 };
+        }
+
+        // several threads on one THREADED heap share a tracer. every record has to parse and
+        // no address may come back as an alloc before the free that gave it up
+        pair<bool, int> threaded_record() {
+            using Heap = MemAllocator<THREADED, Data::MEM_SIZE>;
+            constexpr int THREAD_AMNT = 4;
+
+            Heap mem;
+            FILE *f = tmpfile();
+            size_t ops = 0;
+
+            {
+                MemTracer<Heap> t(mem, f);
+                vector<thread> threads;
+
+                for(int i = 0; i < THREAD_AMNT; i++)
+                    threads.emplace_back([&t, i]() {
+                        mt19937 gen(i);
+                        vector<void*> v;
+
+                        for(int j = 0; j < OP_AMNT / THREAD_AMNT; j++) {
+                            if(v.empty() || gen() % 2)
+                                v.push_back(t.mem_alloc(gen() % 256 + 1));
+                            else {
+                                t.mem_free(v.back());
+                                v.pop_back();
+                            }
+                        }
+
+                        for(void *x : v)
+                            t.mem_free(x);
+                    });
+
+                for(auto &th : threads)
+                    th.join();
+            }
+
+            rewind(f);
+            TraceReader reader(f);
+            if(!reader.valid) {
+                fclose(f);
+                return { false, 0 };
+            }
+
+            unordered_set<uintptr_t> live;
+            TraceReader::Record r;
+            int err = -1;
+
+            while(err == -1 && reader.next(r)) {
+                ops++;
+
+                if(r.op == TRACE_ALLOC && !live.insert(r.id).second)
+                    err = 1;
+                else if(r.op == TRACE_FREE && !live.erase(r.id))
+                    err = 2;
+                else if(r.op == TRACE_REALLOC)
+                    err = 3;
+            }
+
+            fclose(f);
+
+            if(err != -1)
+                return { false, err };
+
+            // each thread allocs and frees every block once, so nothing stays live
+            if(!live.empty() || ops % 2)
+                return { false, 4 };
+
+            return { true, -1 };
+        }
+
+    public:
+        ~Traces() {
+            if(file)
+                fclose(file);
+        }
+};
@@ -0,0 +1,11 @@
+#include <iostream> 
+#include "Bench/benchMain.cpp"
+
+using namespace std; 
+
+int main() {
+    Benchmarks b;
+
+    b.run_benchmarks();
+    return 0; 
+}
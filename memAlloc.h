@@ -1,632 +1,3907 @@
+#pragma once
+
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <cerrno>
 #include <stddef.h>
+#include <cstddef>
 #include <cstdint>
 #include <stdio.h>
 #include <iostream>
 #include <cstring>
+#include <string>
+#include <type_traits>
+#include <atomic>
+#include <thread>
+#include <mutex>
 
 
 #define DEBUG 
-#define TRACK_USE
 
 
-enum Presets { FAST, PRECISE }; 
+enum Presets { FAST, PRECISE, THREADED, TLSF, SLAB, BUMP, CONCURRENT, SHARED }; 
 
-template<const Presets P = Presets::FAST, const size_t MEM_SIZE = 16*1024*1024> 
-class MemAllocator; 
+// what backs the arena, HUGE_PAGES come out of the kernels preallocated pool (vm.nr_hugepages), 
+// TRANSPARENT_HUGE_PAGES are normal pages the kernel may merge into 2MB ones (MADV_HUGEPAGE)
+enum Pages { SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGE_PAGES }; 
+
+struct MemOptions {
+    Pages       pages       = SMALL_PAGES;  // what to try, if the kernel refuses it falls back to the next smaller one
+    bool        prefault    = false;        // commit and touch the whole range on construction instead of on first use
+    size_t      largeSize   = 1024*1024;    // allocs from this size on get a mapping of their own (FAST, PRECISE, THREADED), 0 keeps everything in the arena
+    bool        deferCoalescing = false;    // PRECISE: frees wait in a cache per size class, merging runs once an alloc misses or on compact()
+    size_t      trimThreshold   = 0;        // FAST, PRECISE: once this many bytes behind the top or in one free block are unused, mem_free gives their pages back. 0 leaves it to mem_trim()
+}; 
 
-template<const size_t MEM_SIZE>
-class MemAllocator<FAST, MEM_SIZE> {
+// a word only its owner changes while other threads may read it (THREADED stats). like the TrackStats counters 
+// its stored with relaxed loads and stores, plain movs, so the owner pays nothing. readers take acquire()
+template<typename T>
+class Published {
 
     private: 
-        #ifdef DEBUG 
-            friend class AllocAndFree; 
-        #endif
+        std::atomic<T> v; 
 
-        struct Block {
-            size_t size, offset; 
-            Block *next; 
-        };
+    public: 
+        Published(const T x) : v(x) {}
 
-        static constexpr    uint8_t     SIZE_CLASS_NUM          = 8,
-                                        MIN_BLOCK_SIZE          = 4;
+        inline operator T() const { return v.load(std::memory_order_relaxed); }
+        inline T acquire() const { return v.load(std::memory_order_acquire); }
 
-        static constexpr    Block       *SIZE_CLASS_EMPTY       = nullptr; 
-    
-        Block *sizeClasses[SIZE_CLASS_NUM] { nullptr }; // contains only free Blocks
-        void *memory;
-        size_t offset = 0;
-
-        // all these get incremented only when the function was successful
-        #ifdef TRACK_USE 
-            size_t      createBlock                 =       0,
-                        firstFit                    =       0,
-                        bestFit                     =       0,
-                        memAlloc                    =       0, 
-                        memFree                     =       0, 
-                        removeBlockFromClass        =       0,
-                        addBlockToClass             =       0,
-                        splitDone                   =       0,
-                        coalescingDone              =       0; 
+        inline Published &operator=(const T x) { v.store(x, std::memory_order_relaxed); return *this; }
+        inline Published &operator+=(const T x) { return *this = *this + x; }
+        inline Published &operator-=(const T x) { return *this = *this - x; }
+}; 
 
-        #endif 
+// the address range every heap works in. 
+// the whole size gets reserved up front without backing it (PROT_NONE, MAP_NORESERVE), 
+// pages are committed in chunks once the heap grows into them, so a big MEM_SIZE costs nothing until its used. 
+// one range keeps all blocks contiguous, so neighbours found by offset are valid across chunk borders.
+class Arena {
 
-        void *get_memory(const size_t size) {
-            void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    private: 
+        #ifdef DEBUG 
+            friend class AllocAndFree; 
+        #endif 
 
-            if(mem != MAP_FAILED) 
-                return mem; 
-            
-            perror("mmap");
-            exit(1);
+        static constexpr    size_t      COMMIT_CHUNK            = 1024*1024, 
+                                        HUGE_PAGE               = 2*1024*1024, 
+                                        PAGE                    = 4096; 
+
+        void *memory; 
+        size_t size; 
+        Published<size_t> committed { 0 }; // read by THREADED stats() on other threads
+        size_t chunk = COMMIT_CHUNK; 
+        Pages mode = SMALL_PAGES; 
+        bool populated = false, 
+             borrowed = false; // range belongs to another arena, dont unmap it
+
+        // reserved range starting on an align boundary, the over-reserved ends get unmapped again
+        static void *reserve(const size_t size, const size_t align) {
+            char *mem = (char*)mmap(NULL, size + align, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0); 
+            if(mem == MAP_FAILED) 
+                return MAP_FAILED; 
+
+            char *aligned = (char*)(((uintptr_t)mem + align - 1) & ~(align - 1)); 
+            if(aligned != mem) 
+                munmap(mem, aligned - mem); 
+
+            munmap(aligned + size, mem + align - aligned); 
+            return aligned; 
         }
 
-        inline uint8_t get_size_class(const size_t size) const {
-            if(size <= 16)          return 0; 
-            else if(size <= 32)     return 1; 
-            else if(size <= 64)     return 2; 
-            else if(size <= 128)    return 3; 
-            else if(size <= 256)    return 4; 
-            else if(size <= 512)    return 5;
-            else if(size <= 1024)   return 6;
-            else                    return 7;
-        }
-        
-        inline bool size_control(size_t &size) {
-            if(size < MIN_BLOCK_SIZE) {  
-                size = MIN_BLOCK_SIZE; 
-            }
-            
-            return size + sizeof(Block) <= MEM_SIZE - offset; 
+        // back everything now, so no page fault is left for later
+        void prefault() {
+            if(!grow(size)) 
+                return; 
+
+            #ifdef MADV_POPULATE_WRITE
+                if(!madvise(memory, committed, MADV_POPULATE_WRITE)) {
+                    populated = true; 
+                    return; 
+                }
+            #endif 
+
+            // older kernels, a read would only map the shared zero page
+            for(size_t i = 0; i < committed; i += PAGE) 
+                ((volatile char*)memory)[i] = 0; 
+
+            populated = true; 
         }
-        
-        void remove_block_from_class(const Block *bl, const uint8_t sizeClass) {
-            Block *tmp = sizeClasses[sizeClass]; 
 
-            // we cant use the standard dummy method here because in case all memory is used making a new dumm block leads to a segfault 
-            if(tmp->offset == bl->offset) {
-                sizeClasses[sizeClass] = tmp->next; 
-                return; 
+    public: 
+
+        Arena(const size_t size, const MemOptions &opts = MemOptions()) : size((size + PAGE - 1) & ~(PAGE - 1)) {
+            // the pool either has enough huge pages for the whole range or the mmap fails, 
+            // so the range is fully backed from the start and never gets committed in chunks
+            if(opts.pages == HUGE_PAGES) {
+                const size_t hugeSize = (size + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1); 
+                memory = mmap(NULL, hugeSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB | (opts.prefault ? MAP_POPULATE : 0), -1, 0); 
+
+                if(memory != MAP_FAILED) {
+                    this->size = committed = hugeSize; 
+                    mode = HUGE_PAGES; 
+                    populated = opts.prefault; 
+                    return; 
+                }
             }
 
-            Block *tmp2 = tmp; 
-            while(tmp2->next) {
-                if(tmp2->next->offset == bl->offset) { // every block has a unique offset so we can use it for identification
-                    tmp2->next = tmp2->next->next; 
-                    break; 
+            // transparent huge pages only form on 2MB aligned ranges, so the range and the commit chunks are aligned to that
+            if(opts.pages != SMALL_PAGES) {
+                memory = reserve(this->size, HUGE_PAGE); 
+
+                if(memory != MAP_FAILED && !madvise(memory, this->size, MADV_HUGEPAGE)) {
+                    mode = TRANSPARENT_HUGE_PAGES; 
+                    chunk = HUGE_PAGE; 
                 }
+            }
+            else 
+                memory = mmap(NULL, this->size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
 
-                tmp2 = tmp2->next;
+            if(memory == MAP_FAILED) {
+                perror("mmap");
+                exit(1);
             }
 
-            sizeClasses[sizeClass] = tmp; 
+            if(opts.prefault) 
+                prefault(); 
+        }
 
-            #ifdef TRACK_USE 
-                removeBlockFromClass++; 
-            #endif 
+        // a file other processes map too, like a memfd or a /dev/shm object, size has to be page aligned. 
+        // every process has to reach every page, so the whole range is mapped read/write at once instead of committed in chunks. 
+        // the pages are only backed once someone touches them
+        Arena(const int fd, const size_t size, const MemOptions &opts) : size(size), committed(size) {
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | (opts.prefault ? MAP_POPULATE : 0), fd, 0); 
+
+            if(memory == MAP_FAILED) {
+                perror("mmap");
+                exit(1);
+            }
+
+            populated = opts.prefault; 
         }
 
-        void add_block_to_class(Block *bl) {
-            const uint8_t sizeClass = get_size_class(bl->size);
-            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
-                bl->next = nullptr;
-            else 
-                bl->next = sizeClasses[sizeClass];
-            
-            sizeClasses[sizeClass] = bl;
-            
-            #ifdef TRACK_USE 
-                addBlockToClass++; 
-            #endif 
-        }   
+        // part of an already reserved range, has to be page aligned. 
+        // a fully committed parent means the part is fully committed too
+        Arena(const Arena &parent, void *mem, const size_t size) 
+            : memory(mem), size(size), committed(parent.committed == parent.size ? size : 0), chunk(parent.chunk), 
+              mode(parent.mode), populated(parent.populated), borrowed(true) {}
 
-        Block *create_block(const size_t size) {
-            // enough space to create new Block?
-            if(size + sizeof(Block) > MEM_SIZE - offset) 
-                return nullptr; 
+        ~Arena() { if(!borrowed) munmap(memory, size); }
 
-            Block *bl = (Block*)((char*)memory + offset);
+        Arena(const Arena&) = delete; 
+        Arena &operator=(const Arena&) = delete; 
 
-            bl->size = size; 
-            bl->next = nullptr; 
+        inline void *base() const { return memory; }
+        inline size_t reserved() const { return size; }
+        inline Pages pages() const { return mode; }
+        inline bool prefaulted() const { return populated; }
 
-            offset += sizeof(Block) + size;
-            bl->offset = offset; // start pos of next block
+        // make sure [0, end) is backed, false if end is out of range or the kernel refuses
+        inline bool commit(const size_t end) {
+            if(end <= committed) 
+                return true; 
 
-            #ifdef TRACK_USE 
-                createBlock++;
-            #endif 
+            return grow(end); 
+        }
 
-            return bl;
+        bool grow(const size_t end) {
+            if(end > size) 
+                return false; 
+
+            size_t newCommitted = (end + chunk - 1) / chunk * chunk; 
+            if(newCommitted > size) 
+                newCommitted = size; 
+
+            if(mprotect((char*)memory + committed, newCommitted - committed, PROT_READ | PROT_WRITE)) 
+                return false; 
+
+            committed = newCommitted; 
+            return true; 
         }
 
-        Block *split(Block *bl, const size_t size) {
-            if(bl->size < MIN_BLOCK_SIZE + sizeof(Block) + size) // block big enough to split?
-                return nullptr; 
+        // gives the pages in [from, to) back to the kernel, they stay committed and read as zero once touched again. 
+        // only pages that lie completely inside go, huge ones unless the range is SMALL_PAGES. 
+        // to past the committed range means up to its end. returns the bytes given back
+        size_t release(size_t from, size_t to) {
+            const size_t page = (mode == SMALL_PAGES ? PAGE : HUGE_PAGE); 
 
-            //std::cout << "split1; " << bl->size << std::endl; 
-            const uint8_t sizeClass = get_size_class(bl->size); 
-            
-            // create and init nbl at the end of bl
-            Block *nbl = (Block*)((char*)memory + bl->offset - (sizeof(Block) + size));
-            nbl->size = size; 
-            nbl->offset = bl->offset;
-            nbl->next = nullptr; 
+            if(to > committed) 
+                to = committed; 
 
-            // remove bl from sizeClasses 
-            sizeClasses[sizeClass] = bl->next; // thats okay, because bl is always the first member of the sizeClass
+            from = (from + page - 1) & ~(page - 1); 
+            to &= ~(page - 1); 
 
-            // set new data for bl after splitting
-            bl->size -= (sizeof(Block) + size); 
-            bl->offset -= (sizeof(Block) + size);
-            bl->next = nullptr;  
-            
-            // sort bl back into sizeClasses
-            const uint8_t newSizeClass = get_size_class(bl->size);
-            if(sizeClasses[newSizeClass] == SIZE_CLASS_EMPTY) 
-                bl->next = nullptr;
-            else 
-                bl->next = sizeClasses[newSizeClass];
-            
-            sizeClasses[newSizeClass] = bl;
-            
-            #ifdef TRACK_USE 
-                splitDone++; 
-            #endif 
-            
-            return nbl;
+            if(from >= to || madvise((char*)memory + from, to - from, MADV_DONTNEED)) 
+                return 0; 
+
+            populated = false; 
+            return to - from; 
         }
-        
-        Block *first_fit(const size_t size) {
-            const uint8_t sizeClass = get_size_class(size); 
-            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
-                return nullptr; 
- 
-            Block *tmp = sizeClasses[sizeClass]; 
 
-            // look for valid Block
-            while(tmp != nullptr) {
-                if(tmp->size >= size) {
-                    #ifdef TRACK_USE 
-                        firstFit++; 
-                    #endif 
-                   
-                    remove_block_from_class(tmp, sizeClass); 
+        // bytes of the committed range that are in memory right now, O(committed pages)
+        size_t resident() const {
+            unsigned char vec[4096]; 
+            size_t bytes = 0; 
 
-                    return tmp; 
-                }
+            const size_t committed = this->committed.acquire(); 
 
-                tmp = tmp->next; 
+            for(size_t pos = 0; pos < committed; pos += sizeof(vec) * PAGE) {
+                const size_t len = (committed - pos < sizeof(vec) * PAGE ? committed - pos : sizeof(vec) * PAGE); 
+                if(mincore((char*)memory + pos, len, vec)) 
+                    return bytes; 
+
+                for(size_t i = 0; i < (len + PAGE - 1) / PAGE; i++) 
+                    bytes += (vec[i] & 1) * PAGE; 
             }
 
-            // no Block found
-            return nullptr;
+            return bytes; 
         }
+}; 
 
-        Block *get_block(const size_t size) {           
-            Block *ret = first_fit(size);
- 
-            // best -/ first_fit wasn't able to find a block
-            // look in higher sizeClasses for a Block to split
-            if(!ret) {
-                uint8_t sizeClass = get_size_class(size * 2); 
-                for(; sizeClass < SIZE_CLASS_NUM; sizeClass++) {
-                    if(sizeClasses[sizeClass] != SIZE_CLASS_EMPTY) {
-                        ret = split(sizeClasses[sizeClass], size);
-                        
-                        if(ret) 
-                            break;
-                    }
-                }
-            }
-        
-            // if first_fit & splitting failed, try creating a new block
-            if(!ret) 
-                return create_block(size); 
+// blocks with a mapping of their own, outside of the arena. the payload is the start of the mapping, 
+// so there is no header, a small open addressing table maps it to the mapped bytes instead. 
+// the table is mmapped too, a heap behind malloc (memShim.cpp) must not call malloc
+class LargeBlocks {
 
-            return ret; 
+    public: 
+        static constexpr    size_t      PAGE                    = 4096; 
 
-            //return (ret ? ret : create_block(size));
-        }
+    private: 
+        static constexpr    size_t      MIN_CAPACITY            = PAGE / (2 * sizeof(size_t)); 
 
-        #ifdef DEBUG 
-            inline size_t fast_block_size() const {
-                return sizeof(Block); 
-            }
+        struct Entry {
+            void *ptr;      // nullptr for an empty slot
+            size_t bytes; 
+        }; 
 
-            void print_size_classes() {
-                for(int i = 0; i < 8; i++) {
-                    std::cout << std::endl << i << " - ";
-                    if(sizeClasses[i] == SIZE_CLASS_EMPTY)  {
-                        std::cout << "empty";
-                        continue;
-                    }
+        Entry *table = nullptr; 
+        size_t capacity = 0, 
+               count = 0, 
+               mapped = 0; // bytes of all mappings
 
+        static inline size_t pages(const size_t size) { return (size + PAGE - 1) & ~(PAGE - 1); }
 
-                    Block *tmp = sizeClasses[i]; 
- 
-                    while(tmp != nullptr) {
-                        
-                        std::cout << tmp->size << ", "; 
-                        tmp = tmp->next; 
-                    }
-                }
+        inline size_t slot(const void *ptr) const {
+            return (((uintptr_t)ptr / PAGE) * 0x9E3779B97F4A7C15ull) & (capacity - 1); 
+        }
 
-                std::cout << "\n\n"; 
+        inline Entry *find(const void *ptr) const {
+            if(!count) 
+                return nullptr; 
+
+            for(size_t i = slot(ptr);; i = (i + 1) & (capacity - 1)) {
+                if(table[i].ptr == ptr) 
+                    return &table[i]; 
+
+                if(!table[i].ptr) 
+                    return nullptr; 
             }
-        #endif 
+        }
 
-    public:
+        void insert(void *ptr, const size_t bytes) {
+            size_t i = slot(ptr); 
+            while(table[i].ptr) 
+                i = (i + 1) & (capacity - 1); 
 
-        MemAllocator() { memory = get_memory(MEM_SIZE); }
-        ~MemAllocator() { munmap(memory, MEM_SIZE); }
+            table[i] = { ptr, bytes }; 
+            count++; 
+            mapped += bytes; 
+        }
 
-        void *mem_alloc(size_t size) {
-            Block *bl = get_block((size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size));
+        // linear probing without tombstones, entries behind the hole move up if their probe passes it
+        void erase(Entry *e) {
+            size_t hole = e - table; 
+            mapped -= e->bytes; 
 
-            if(!bl) 
-                return nullptr; 
+            for(size_t i = (hole + 1) & (capacity - 1); table[i].ptr; i = (i + 1) & (capacity - 1)) {
+                const size_t home = slot(table[i].ptr); 
 
-            
-            #ifdef TRACK_USE
-                memAlloc++;
-            #endif 
-            
-            return (char*)bl + sizeof(Block); // user memory
+                if(((i - home) & (capacity - 1)) >= ((i - hole) & (capacity - 1))) {
+                    table[hole] = table[i]; 
+                    hole = i; 
+                }
+            }
+
+            table[hole] = { nullptr, 0 }; 
+            count--; 
         }
-     
-        bool mem_free(void *ptr) {
-            // check for null or foreign ptr
-            if(!ptr || ptr < memory || ptr > (char*)memory + MEM_SIZE) 
+
+        // keeps the table at most half full
+        bool reserve_slot() {
+            if(2 * (count + 1) <= capacity) 
+                return true; 
+
+            const size_t newCapacity = (capacity ? 2 * capacity : MIN_CAPACITY); 
+            Entry *newTable = (Entry*)mmap(NULL, newCapacity * sizeof(Entry), PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0); 
+            if(newTable == MAP_FAILED) 
                 return false; 
-                
-            Block *bl = (Block*)((char*)ptr - sizeof(Block));
 
-            add_block_to_class(bl); 
+            Entry *old = table; 
+            const size_t oldCapacity = capacity; 
+
+            table = newTable; 
+            capacity = newCapacity; 
+            count = mapped = 0; 
+
+            for(size_t i = 0; i < oldCapacity; i++) 
+                if(old[i].ptr) 
+                    insert(old[i].ptr, old[i].bytes); 
+
+            if(old) 
+                munmap(old, oldCapacity * sizeof(Entry)); 
 
-            #ifdef TRACK_USE
-                memFree++;
-            #endif
-            
             return true; 
         }
 
+    public: 
 
-        /////////////////////////////////////////
-        void *mem_realloc(void *ptr, size_t size) {
-            if(size == 0) {
-                mem_free(ptr); 
+        LargeBlocks() {}
+
+        ~LargeBlocks() {
+            for(size_t i = 0; i < capacity; i++) 
+                if(table[i].ptr) 
+                    munmap(table[i].ptr, table[i].bytes); 
+
+            if(table) 
+                munmap(table, capacity * sizeof(Entry)); 
+        }
+
+        LargeBlocks(const LargeBlocks&) = delete; 
+        LargeBlocks &operator=(const LargeBlocks&) = delete; 
+
+        inline size_t size() const { return count; }
+        inline size_t bytes() const { return mapped; }
+
+        // MemOptions::largeSize as the size from which on allocs get mapped
+        static inline size_t threshold(const size_t largeSize) { return (largeSize ? largeSize : SIZE_MAX); }
+
+        // mapped bytes of ptr, 0 if it isnt one of ours
+        inline size_t size_of(const void *ptr) const {
+            const Entry *e = find(ptr); 
+            return (e ? e->bytes : 0); 
+        }
+
+        void *map(const size_t size) {
+            if(!reserve_slot()) 
                 return nullptr; 
-            }
 
-            if(!size_control(size))
-                return nullptr;
-            
-            if(!ptr) 
-                return mem_alloc(size); 
-            
-            
-            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            const size_t bytes = pages(size); 
+            void *ptr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0); 
+            if(ptr == MAP_FAILED) 
+                return nullptr; 
 
-            if(bl->size == size) 
-                return ptr; 
+            insert(ptr, bytes); 
+            return ptr; 
+        }
 
-            // shrink in place
-            if(size < bl->size) {
-                const size_t tmpOffset = bl->offset;
-                bl->offset -= bl->size - size; // <--- BLOCK FRAGMENTATION HERE
-                
-                if(tmpOffset == offset) 
-                    offset = bl->offset;
+        // the kernel moves the page table entries if the mapping cant grow where it is, the data is never copied
+        void *remap(void *ptr, const size_t size) {
+            Entry *e = find(ptr); 
+            if(!e) 
+                return nullptr; 
 
-                bl->size = size; 
-                return ptr; 
-            }
+            const size_t bytes = pages(size); 
+            void *x = mremap(ptr, e->bytes, bytes, MREMAP_MAYMOVE); 
+            if(x == MAP_FAILED) 
+                return nullptr; 
 
-            // grow in place
-            if(bl->offset == offset) {
-                bl->offset += size - bl->size; 
-                offset = bl->offset; 
-                bl->size = size; 
-                
-                return ptr; 
+            if(x == ptr) {
+                mapped += bytes - e->bytes; 
+                e->bytes = bytes; 
+                return x; 
             }
 
-            // realloc in new block 
-            Block *nbl = create_block(size); 
-            
-            std::memcpy((char*)nbl + sizeof(Block), ptr, bl->size); 
-            
-            mem_free(ptr); 
+            // the table only grows in map(), the old entry frees the slot we need
+            erase(e); 
+            insert(x, bytes); 
+            return x; 
+        }
 
-            return (char*)nbl + sizeof(Block); 
+        bool unmap(void *ptr) {
+            Entry *e = find(ptr); 
+            if(!e) 
+                return false; 
+
+            munmap(ptr, e->bytes); 
+            erase(e); 
+            return true; 
         }
 }; 
 
+// what stats() returns, a copy thats safe to keep and export. 
+// classes are the size classes of the preset (FAST, PRECISE, SLAB) or the first level lists (TLSF)
+struct MemStats {
+    static constexpr    uint8_t     CLASS_NUM               = 64; 
+
+    struct Class {
+        size_t  liveCount, liveBytes,   // handed out right now, payload bytes
+                freeCount, freeBytes;   // sitting in the free lists
+    }; 
+
+    bool        tracked         = false;    // false for NoStats, only used, reserved, resident, the large blocks and the page options are filled in then
+    size_t      allocs          = 0, 
+                frees           = 0, 
+                failedAllocs    = 0, 
+                splits          = 0, 
+                coalesces       = 0, 
+                highWater       = 0,        // highest offset the bump region reached
+                used            = 0,        // mem_used() 
+                reserved        = 0,        // MEM_SIZE
+                largeBlocks     = 0,        // blocks with a mapping of their own, see MemOptions::largeSize
+                largeBytes      = 0, 
+                resident        = 0;        // arena bytes in memory right now, large blocks not included. O(pages) to find out
+    Pages       pages           = SMALL_PAGES; 
+    bool        prefaulted      = false; 
+    Class       classes[CLASS_NUM] { }; 
+
+    // sums up several heaps, like the ones of THREADED
+    MemStats &operator+=(const MemStats &o) {
+        tracked |= o.tracked; 
+        allocs += o.allocs; 
+        frees += o.frees; 
+        failedAllocs += o.failedAllocs; 
+        splits += o.splits; 
+        coalesces += o.coalesces; 
+        highWater += o.highWater; 
+        used += o.used; 
+        reserved += o.reserved; 
+        largeBlocks += o.largeBlocks; 
+        largeBytes += o.largeBytes; 
+        resident += o.resident; 
+
+        for(uint8_t i = 0; i < CLASS_NUM; i++) {
+            classes[i].liveCount += o.classes[i].liveCount; 
+            classes[i].liveBytes += o.classes[i].liveBytes; 
+            classes[i].freeCount += o.classes[i].freeCount; 
+            classes[i].freeBytes += o.classes[i].freeBytes; 
+        }
+
+        return *this; 
+    }
+}; 
+
+// stats policy, every call compiles to nothing
+struct NoStats {
+    static constexpr    bool        ENABLED                 = false; 
+
+    inline void alloc(uint8_t, size_t) {}
+    inline void free(uint8_t, size_t) {}
+    inline void failed() {}
+    inline void listed(uint8_t, size_t) {}
+    inline void unlisted(uint8_t, size_t) {}
+    inline void resized(uint8_t, size_t, uint8_t, size_t) {}
+    inline void split() {}
+    inline void coalesce() {}
+    inline void offset(size_t) {}
+    inline void snapshot(MemStats&) const {}
+}; 
+
+// stats policy that counts. a heap is only ever changed by one thread at a time, so the counters 
+// are bumped with a relaxed load + store (a plain add, no lock prefix) and other threads can still read them without tearing
+class TrackStats {
 
-template<const size_t MEM_SIZE>
-class MemAllocator<PRECISE, MEM_SIZE> {
- 
     private: 
-        #ifdef DEBUG 
-            friend class AllocAndFree; 
-        #endif 
+        using Counter = std::atomic<size_t>; 
 
-        struct Block {
-            size_t size, offset;
-            Block *next;
-            bool free;
-        };
-        
-        static constexpr    uint8_t     SIZE_CLASS_NUM          = 20,
-                                        MIN_BLOCK_SIZE          = 4;
+        static constexpr    uint8_t     CLASS_NUM               = MemStats::CLASS_NUM; 
 
-        static constexpr    bool        FREE                    = true,
-                                        NOT_FREE                = false;
-        
-        static constexpr    Block       *SIZE_CLASS_EMPTY       = nullptr;
+        Counter allocs { 0 }, frees { 0 }, failedAllocs { 0 }, splits { 0 }, coalesces { 0 }, highWater { 0 }; 
+        Counter liveCount[CLASS_NUM] { }, liveBytes[CLASS_NUM] { }, freeCount[CLASS_NUM] { }, freeBytes[CLASS_NUM] { }; 
 
-        Block *sizeClasses[SIZE_CLASS_NUM] { nullptr }; // contains only free Blocks
-        void *memory;
-        size_t offset = 0;   
-        
-        // all these get incremented only when the function was successful
-        #ifdef TRACK_USE 
-            uint32_t    createBlock                 =       0,
-                        firstFit                    =       0,
-                        bestFit                     =       0,
-                        memAlloc                    =       0, 
-                        memFree                     =       0, 
-                        removeBlockFromClass        =       0,
-                        addBlockToClass             =       0,
-                        splitDone                   =       0,
-                        coalescingDone              =       0; 
-        #endif 
+        static inline void add(Counter &c, const size_t x) { c.store(c.load(std::memory_order_relaxed) + x, std::memory_order_relaxed); }
+        static inline void sub(Counter &c, const size_t x) { c.store(c.load(std::memory_order_relaxed) - x, std::memory_order_relaxed); }
+        static inline size_t get(const Counter &c) { return c.load(std::memory_order_relaxed); }
 
-        void get_memory() {
-            memory = mmap(NULL, MEM_SIZE, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    public: 
+        static constexpr    bool        ENABLED                 = true; 
 
-            if(memory == MAP_FAILED) {
-                perror("mmap");
-                exit(1);
-            }
+        inline void alloc(const uint8_t c, const size_t bytes) { add(allocs, 1); add(liveCount[c], 1); add(liveBytes[c], bytes); }
+        inline void free(const uint8_t c, const size_t bytes) { add(frees, 1); sub(liveCount[c], 1); sub(liveBytes[c], bytes); }
+        inline void failed() { add(failedAllocs, 1); }
+        inline void listed(const uint8_t c, const size_t bytes) { add(freeCount[c], 1); add(freeBytes[c], bytes); }
+        inline void unlisted(const uint8_t c, const size_t bytes) { sub(freeCount[c], 1); sub(freeBytes[c], bytes); }
+
+        // live block changed its size in place (realloc)
+        inline void resized(const uint8_t from, const size_t fromBytes, const uint8_t to, const size_t toBytes) {
+            sub(liveCount[from], 1); sub(liveBytes[from], fromBytes); 
+            add(liveCount[to], 1); add(liveBytes[to], toBytes); 
         }
-    
-        inline uint8_t get_size_class(const size_t size) const {
-            if(size <= 4)           return 0; 
-            else if(size <= 8)      return 1;
-            else if(size <= 16)     return 2;
-            else if(size <= 32)     return 3;
-            else if(size <= 48)     return 4;
-            else if(size <= 64)     return 5;
-            else if(size <= 80)     return 6;
-            else if(size <= 96)     return 7;
-            else if(size <= 128)    return 8;
-            else if(size <= 160)    return 9;
-            else if(size <= 192)    return 10;
-            else if(size <= 256)    return 11;
-            else if(size <= 320)    return 12;
-            else if(size <= 384)    return 13;
-            else if(size <= 512)    return 14;
-            else if(size <= 640)    return 15;
-            else if(size <= 768)    return 16;
-            else if(size <= 896)    return 17;
-            else if(size <= 1024)   return 18;
-            else                    return 19;
+        inline void split() { add(splits, 1); }
+        inline void coalesce() { add(coalesces, 1); }
+
+        inline void offset(const size_t off) {
+            if(off > get(highWater)) 
+                highWater.store(off, std::memory_order_relaxed); 
+        }
+
+        void snapshot(MemStats &s) const {
+            s.tracked = true; 
+            s.allocs = get(allocs); 
+            s.frees = get(frees); 
+            s.failedAllocs = get(failedAllocs); 
+            s.splits = get(splits); 
+            s.coalesces = get(coalesces); 
+            s.highWater = get(highWater); 
+
+            for(uint8_t i = 0; i < CLASS_NUM; i++) 
+                s.classes[i] = { get(liveCount[i]), get(liveBytes[i]), get(freeCount[i]), get(freeBytes[i]) }; 
+        }
+}; 
+
+// header policies, the integer a block header (FAST, PRECISE, THREADED) keeps its size and offset in. 
+// WideHeader works for any MEM_SIZE, CompactHeader halves the header to 8 bytes for arenas under 4GB
+struct WideHeader {
+    using Word = size_t; 
+}; 
+
+struct CompactHeader {
+    using Word = uint32_t; 
+}; 
+
+// one block of a heap walk
+struct HeapBlock {
+    const void  *ptr;       // payload
+    size_t      size;       // payload bytes
+    bool        free; 
+}; 
+
+// the blocks of a FAST, PRECISE or TLSF heap in address order, from the first header up to offset. 
+// every header knows where the next one starts, so nothing but the heap itself is needed. 
+// the heap must not change while a walk runs, e.g. for (const HeapBlock &bl : mem.walk()) 
+template<typename H> 
+class HeapWalk {
+
+    private: 
+        const H &heap; 
+
+    public: 
+
+        class iterator {
+
+            private: 
+                const H *heap; 
+                size_t pos, next = 0; 
+                HeapBlock bl { nullptr, 0, false }; 
+
+                inline void load() {
+                    if(pos < heap->offset) 
+                        bl = heap->block_at(pos, next); 
+                }
+
+            public: 
+                iterator(const H *heap, const size_t pos) : heap(heap), pos(pos) { load(); }
+
+                inline const HeapBlock &operator*() const { return bl; }
+                inline const HeapBlock *operator->() const { return &bl; }
+
+                inline iterator &operator++() {
+                    pos = next; 
+                    load(); 
+                    return *this; 
+                }
+
+                inline bool operator==(const iterator &other) const { return pos == other.pos; }
+                inline bool operator!=(const iterator &other) const { return pos != other.pos; }
+        }; 
+
+        HeapWalk(const H &heap) : heap(heap) {}
+
+        inline iterator begin() const { return iterator(&heap, H::FIRST_BLOCK); }
+        inline iterator end() const { return iterator(&heap, heap.offset); }
+}; 
+
+// what a heap walk found, see report(). 
+// classes are the same as in MemStats. free blocks are counted in log2 buckets by payload size, 
+// FAST never merges neighbours, largestRun is what merging the biggest stretch of free blocks would give
+struct MemReport {
+    static constexpr    uint8_t     CLASS_NUM               = MemStats::CLASS_NUM, 
+                                    BUCKET_NUM              = 64; 
+
+    size_t      used            = 0,        // mem_used() 
+                reserved        = 0,        // MEM_SIZE
+                headroom        = 0,        // bump region left before the heap hits MEM_SIZE
+                blocks          = 0, 
+                liveBytes       = 0, 
+                freeBytes       = 0, 
+                headerBytes     = 0,        // everything in used that isnt a payload
+                largestFree     = 0,        // biggest alloc the free blocks can serve
+                largestRun      = 0; 
+    uint8_t     classNum        = 0;        // classes the preset has
+    MemStats::Class classes[CLASS_NUM] { }; 
+    size_t      freeCount[BUCKET_NUM] { },  // free blocks of 2^i up to 2^(i+1) - 1 bytes
+                freeSize[BUCKET_NUM] { }; 
+
+    MemReport(const size_t used, const size_t reserved, const uint8_t classNum, const size_t header) 
+        : used(used), reserved(reserved), headroom(reserved - used), classNum(classNum), header(header) {}
+
+    // share of the free bytes that cant be used by one big alloc. the bump region isnt counted, see headroom
+    inline double fragmentation() const { return (freeBytes ? 1.0 - (double)largestFree / freeBytes : 0); }
+
+    // biggest alloc that can still succeed, from a free block or the bump region
+    inline size_t largest_alloc() const {
+        const size_t top = (headroom > header ? headroom - header : 0); 
+        return (largestFree > top ? largestFree : top); 
+    }
+
+    void add(const HeapBlock &bl, const uint8_t sizeClass) {
+        blocks++; 
+
+        if(!bl.free) {
+            liveBytes += bl.size; 
+            classes[sizeClass].liveCount++; 
+            classes[sizeClass].liveBytes += bl.size; 
+            run = 0; 
+            return; 
+        }
+
+        freeBytes += bl.size; 
+        classes[sizeClass].freeCount++; 
+        classes[sizeClass].freeBytes += bl.size; 
+
+        const uint8_t bucket = (bl.size ? 63 - __builtin_clzll(bl.size) : 0); 
+        freeCount[bucket]++; 
+        freeSize[bucket] += bl.size; 
+
+        largestFree = (bl.size > largestFree ? bl.size : largestFree); 
+        run += (run ? header : 0) + bl.size; 
+        largestRun = (run > largestRun ? run : largestRun); 
+    }
+
+    // after the last add
+    inline void finish() { headerBytes = used - liveBytes - freeBytes; }
+
+    // one JSON object, the histogram only lists buckets that have blocks
+    std::string json() const {
+        char buf[256]; 
+        std::string out; 
+
+        snprintf(buf, sizeof(buf), "{\"used\":%zu,\"reserved\":%zu,\"headroom\":%zu,\"largestAlloc\":%zu,\"blocks\":%zu,", 
+                 used, reserved, headroom, largest_alloc(), blocks); 
+        out += buf; 
+
+        snprintf(buf, sizeof(buf), "\"liveBytes\":%zu,\"freeBytes\":%zu,\"headerBytes\":%zu,\"largestFree\":%zu,\"largestRun\":%zu,\"fragmentation\":%.4f,", 
+                 liveBytes, freeBytes, headerBytes, largestFree, largestRun, fragmentation()); 
+        out += buf; 
+
+        out += "\"classes\":["; 
+        for(uint8_t i = 0; i < classNum; i++) {
+            snprintf(buf, sizeof(buf), "%s{\"live\":%zu,\"liveBytes\":%zu,\"free\":%zu,\"freeBytes\":%zu}", (i ? "," : ""), 
+                     classes[i].liveCount, classes[i].liveBytes, classes[i].freeCount, classes[i].freeBytes); 
+            out += buf; 
+        }
+
+        out += "],\"freeBlocks\":["; 
+        bool first = true; 
+        for(uint8_t i = 0; i < BUCKET_NUM; i++) {
+            if(!freeCount[i]) 
+                continue; 
+
+            snprintf(buf, sizeof(buf), "%s{\"min\":%zu,\"count\":%zu,\"bytes\":%zu}", (first ? "" : ","), (size_t)1 << i, freeCount[i], freeSize[i]); 
+            out += buf; 
+            first = false; 
+        }
+
+        out += "]}"; 
+        return out; 
+    }
+
+    private: 
+        size_t header = 0, run = 0; // header size of the preset, free bytes of the stretch the walk is in
+}; 
+
+// ALIGNMENT: every pointer mem_alloc hands out is aligned to it, mem_alloc_aligned goes beyond that
+// STATS: NoStats or TrackStats, see stats()
+// HEADER: WideHeader or CompactHeader
+template<const Presets P = Presets::FAST, const size_t MEM_SIZE = 16*1024*1024, const size_t ALIGNMENT = alignof(std::max_align_t), 
+         typename STATS = NoStats, typename HEADER = WideHeader> 
+class MemAllocator; 
+
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<FAST, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class AllocAndFree; 
+            friend class ThreadedHeaps; 
+            friend class Adapters; 
+        #endif
+
+        // THREADED runs one FAST heap per thread on a slice of its own mapping
+        template<const Presets, const size_t, const size_t, typename, typename> 
+        friend class MemAllocator; 
+
+        template<typename> friend class HeapWalk; 
+
+        using Word = typename HEADER::Word; 
+
+        // offset has FREE set while the block sits in a size class, blocks are always a multiple of 8 apart
+        struct Block {
+            Word size, offset; 
+        };
+
+        // only free blocks have these, stored in their payload so live blocks dont pay for them
+        struct FreeLinks {
+            Block *prev, *next; 
+        };
+
+        static constexpr    uint8_t     SIZE_CLASS_NUM          = 8,
+                                        MIN_BLOCK_SIZE          = sizeof(FreeLinks);
+
+        static constexpr    Block       *SIZE_CLASS_EMPTY       = nullptr; 
+
+        static constexpr    size_t      FREE                    = 1, 
+                                        REALLOC_SCAN            = 16;           // blocks of the size class realloc looks at before it takes a new one
+
+        static constexpr    uint8_t     LARGE_CLASS             = SIZE_CLASS_NUM - 1; 
+
+        // first header sits so that its payload is aligned, every block (header + payload) is a multiple of ALIGNMENT
+        static constexpr    size_t      FIRST_BLOCK             = ((sizeof(Block) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+
+        static_assert(ALIGNMENT >= alignof(FreeLinks) && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, at least pointer sized"); 
+        static_assert(MEM_SIZE <= (Word)-1, "MEM_SIZE too big for CompactHeader"); 
+    
+        Block *sizeClasses[SIZE_CLASS_NUM] { nullptr }; // contains only free Blocks
+        Arena arena; 
+        void *memory;
+        Published<size_t> offset { FIRST_BLOCK };   // read by THREADED stats() on other threads
+        size_t peak = FIRST_BLOCK;                  // highest offset since the pages behind it were last given back
+        LargeBlocks large; 
+        const size_t largeSize, // see MemOptions
+                     trimThreshold; 
+
+        STATS counters; // see stats()
+
+        inline uint8_t get_size_class(const size_t size) const {
+            if(size <= 16)          return 0; 
+            else if(size <= 32)     return 1; 
+            else if(size <= 64)     return 2; 
+            else if(size <= 128)    return 3; 
+            else if(size <= 256)    return 4; 
+            else if(size <= 512)    return 5;
+            else if(size <= 1024)   return 6;
+            else                    return 7;
         }
         
+        // payload has to hold the free links, and keep the next payload aligned
+        static inline size_t adjust_size(const size_t size) {
+            return ((sizeof(Block) + (size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+        }
+
+        static inline FreeLinks *links(Block *bl) { return (FreeLinks*)((char*)bl + sizeof(Block)); }
+
+        void remove_block_from_class(Block *bl, const uint8_t sizeClass) {
+            FreeLinks *l = links(bl); 
+
+            if(l->prev) 
+                links(l->prev)->next = l->next; 
+            else 
+                sizeClasses[sizeClass] = l->next; 
+
+            if(l->next) 
+                links(l->next)->prev = l->prev; 
+
+            bl->offset &= ~FREE; 
+            counters.unlisted(sizeClass, bl->size); 
+        }
+
+        void add_block_to_class(Block *bl) {
+            const uint8_t sizeClass = get_size_class(bl->size);
+            Block *head = sizeClasses[sizeClass]; 
+
+            links(bl)->prev = nullptr; 
+            links(bl)->next = head; 
+            
+            if(head != SIZE_CLASS_EMPTY) 
+                links(head)->prev = bl; 
+
+            sizeClasses[sizeClass] = bl;
+            bl->offset |= FREE; 
+            counters.listed(sizeClass, bl->size); 
+        }   
+
         Block *create_block(const size_t size) {
-            Block *bl = (Block*)((char*)memory + offset); 
+            // enough space to create new Block?
+            if(size + sizeof(Block) > MEM_SIZE - offset || !arena.commit(offset + sizeof(Block) + size)) 
+                return nullptr; 
+
+            Block *bl = (Block*)((char*)memory + offset);
 
             bl->size = size; 
-            bl->next = nullptr;
 
             offset += sizeof(Block) + size;
             bl->offset = offset; // start pos of next block
-            
-            #ifdef TRACK_USE
-                createBlock++;
-            #endif 
+
+            counters.offset(offset); 
 
             return bl;
         }
 
-        void remove_block_from_class(const Block *bl, const uint8_t sizeClass) {
-            Block *dummy = (Block*)((char*)memory + offset); 
-            dummy->next = sizeClasses[sizeClass];
-            Block *tmp = dummy; 
+        // k blocks of the same size back to back from the bump region, one bounds check and commit for all of them
+        size_t create_run(const size_t size, size_t k, void **out) {
+            const size_t step = sizeof(Block) + size; 
 
-            while(tmp->next != nullptr) {
-                if(tmp->next->offset == bl->offset) { // every block has a unique offset so we can use it for identification
-                    tmp->next = tmp->next->next;
-                    break; 
-                }
-                tmp = tmp->next;
+            if(k > (MEM_SIZE - offset) / step) 
+                k = (MEM_SIZE - offset) / step; 
+
+            if(!arena.commit(offset + k * step)) 
+                return 0; 
+
+            for(size_t i = 0; i < k; i++) {
+                Block *bl = (Block*)((char*)memory + offset); 
+                bl->size = size; 
+
+                offset += step; 
+                bl->offset = offset; 
+
+                out[i] = (char*)bl + sizeof(Block); 
             }
 
-            sizeClasses[sizeClass] = dummy->next;
-            
-            #ifdef TRACK_USE 
-                removeBlockFromClass++; 
-            #endif 
+            counters.offset(offset); 
+
+            return k; 
         }
 
-        void add_block_to_class(Block *bl) {
-            const uint8_t sizeClass = get_size_class(bl->size);
-            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
-                bl->next = nullptr;
-            else 
-                bl->next = sizeClasses[sizeClass];
-            
-            sizeClasses[sizeClass] = bl;
-            
-            #ifdef TRACK_USE 
-                addBlockToClass++; 
-            #endif 
-        }   
-     
         Block *split(Block *bl, const size_t size) {
-            if(bl->size < MIN_BLOCK_SIZE + sizeof(Block) + size) // block big enough to split? 
+            if(bl->size < MIN_BLOCK_SIZE + sizeof(Block) + size) // block big enough to split?
                 return nullptr; 
 
-            const uint8_t sizeClass = get_size_class(bl->size); 
+            // remove bl from sizeClasses 
+            remove_block_from_class(bl, get_size_class(bl->size)); 
             
             // create and init nbl at the end of bl
             Block *nbl = (Block*)((char*)memory + bl->offset - (sizeof(Block) + size));
             nbl->size = size; 
             nbl->offset = bl->offset;
-            nbl->next = nullptr; 
-            nbl->free = FREE;
-
-            // remove bl from sizeClasses 
-            sizeClasses[sizeClass] = bl->next; // thats okay, because bl is always the first member of the sizeClass
 
             // set new data for bl after splitting
             bl->size -= (sizeof(Block) + size); 
             bl->offset -= (sizeof(Block) + size);
-            bl->next = nullptr;  
             
             // sort bl back into sizeClasses
             add_block_to_class(bl); 
             
-            #ifdef TRACK_USE 
-                splitDone++; 
-            #endif 
+            counters.split(); 
             
             return nbl;
         }
         
-        void coalescing(Block* bl) {
-            // cant be any Block infront of bl
-            if(bl->offset == offset) 
-                return; 
-
-            // get next block after bl
-            Block *nbl = (Block*)((char*)memory + bl->offset);
-            if(!nbl->free)
-                return; 
-            
-            remove_block_from_class(nbl, get_size_class(nbl->size));
-            
-            // merge nbl and bl
-            bl->offset = nbl->offset;
-            bl->size += sizeof(Block) + nbl->size;
-
-            #ifdef TRACK_USE
-                coalescingDone++; 
-            #endif 
-        }
-
-        Block *first_fit(const size_t size) {
+        // looks at no more than scan blocks of the class
+        Block *first_fit(const size_t size, size_t scan = SIZE_MAX) {
             const uint8_t sizeClass = get_size_class(size); 
             if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
                 return nullptr; 
-            
+ 
             Block *tmp = sizeClasses[sizeClass]; 
 
             // look for valid Block
-            while(tmp != nullptr) {
+            while(tmp != nullptr && scan--) {
                 if(tmp->size >= size) {
-                    #ifdef TRACK_USE 
-                        firstFit++; 
-                    #endif 
-                   
                     remove_block_from_class(tmp, sizeClass); 
+
                     return tmp; 
                 }
 
-                tmp = tmp->next; 
+                tmp = links(tmp)->next; 
             }
-            
+
             // no Block found
             return nullptr;
         }
 
-        Block *best_fit(const size_t size) {
-            const uint8_t sizeClass = get_size_class(size); 
-            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
-                return nullptr; 
+        // first address in a payload thats aligned and leaves either no gap or one big enough to be a free block
+        static inline char *aligned_payload(char *payload, const size_t alignment) {
+            char *p = (char*)(((uintptr_t)payload + alignment - 1) & ~(alignment - 1)); 
 
-            Block *tmp = sizeClasses[sizeClass],
-                  *bestFit = nullptr; 
-            
-            // look for valid Block
-            while(tmp != nullptr) {
-                if((bestFit == nullptr || tmp->size < bestFit->size) && tmp->size >= size) {
-                    bestFit = tmp; 
-                    
-                    if(bestFit->size == size)
-                        break; 
-                }
-            }
+            while(p != payload && (size_t)(p - payload) < sizeof(Block) + MIN_BLOCK_SIZE) 
+                p += alignment; 
 
-            // no Block found
-            if(bestFit == nullptr)
-                return nullptr;
+            return p; 
+        }
 
-            #ifdef TRACK_USE 
-                bestFit++; 
-            #endif 
+        // moves the start of bl up until its payload is aligned, the gap in front becomes a free block
+        Block *cut_front(Block *bl, const size_t alignment) {
+            char *payload = (char*)bl + sizeof(Block), 
+                 *p = aligned_payload(payload, alignment); 
+
+            if(p == payload) 
+                return bl; 
 
-            remove_block_from_class(bestFit, sizeClass);
-            return bestFit; 
+            Block *abl = (Block*)(p - sizeof(Block)); 
+            abl->size = bl->size - (p - payload); 
+            abl->offset = bl->offset; 
+
+            bl->size = (char*)abl - payload; 
+            bl->offset = (char*)abl - (char*)memory; 
+            add_block_to_class(bl); 
+
+            return abl; 
         }
 
-        Block *get_block(const size_t size) {
-            Block *ret;
-            uint8_t sizeClass = get_size_class(size);
+        // everything in bl past size becomes a free block
+        void cut_tail(Block *bl, const size_t size) {
+            if(bl->size < size + sizeof(Block) + MIN_BLOCK_SIZE) 
+                return; 
 
-            // the higher the sizeClass, the more the size can vary.
-            // for lower classes, with 4-32b flucatuation, first_fit is efficient enough,
-            // for higher classes, with 64-128b fluctuation, best_fit is used to reduce fragmentation
-            if(sizeClass <= 10) 
-                ret = first_fit(size);
-            else 
-                ret = best_fit(size);
+            Block *tbl = (Block*)((char*)bl + sizeof(Block) + size); 
+            tbl->size = bl->size - size - sizeof(Block); 
+            tbl->offset = bl->offset; 
+
+            bl->size = size; 
+            bl->offset = (char*)tbl - (char*)memory; 
+            add_block_to_class(tbl); 
+        }
 
+        // a free block for size, nullptr if the size classes have none
+        Block *find_block(const size_t size, const size_t scan = SIZE_MAX) {           
+            Block *ret = first_fit(size, scan);
+ 
             // best -/ first_fit wasn't able to find a block
             // look in higher sizeClasses for a Block to split
-            if(ret == nullptr) {
-                sizeClass = get_size_class(size * 2); 
+            if(!ret) {
+                uint8_t sizeClass = get_size_class(size * 2); 
                 for(; sizeClass < SIZE_CLASS_NUM; sizeClass++) {
                     if(sizeClasses[sizeClass] != SIZE_CLASS_EMPTY) {
                         ret = split(sizeClasses[sizeClass], size);
                         
-                        if(ret != nullptr) 
+                        if(ret) 
                             break;
                     }
                 }
             }
-            
-            // if best/first_fit & splitting failed, create a new block
+        
+            return ret; 
+        }
+
+        Block *get_block(const size_t size) {
+            Block *ret = find_block(size); 
+
+            // if first_fit & splitting failed, try creating a new block
             return (ret ? ret : create_block(size));
         }
 
+        // offset moves back to pos, once trimThreshold bytes behind it are unused their pages go back to the kernel
+        void lower_top(const size_t pos) {
+            if(offset > peak) 
+                peak = offset; 
+
+            offset = pos; 
+
+            if(peak - offset >= trimThreshold) {
+                arena.release(offset, peak); 
+                peak = offset; 
+            }
+        }
+
+        // the whole pages inside a free blocks payload, its links stay
+        inline size_t release_free(Block *bl) {
+            const size_t payload = (char*)bl + sizeof(Block) - (char*)memory; 
+            return arena.release(payload + sizeof(FreeLinks), payload + bl->size); 
+        }
+
+        // header at pos as a heap walk sees it, next is where the block behind it starts
+        inline HeapBlock block_at(const size_t pos, size_t &next) const {
+            const Block *bl = (const Block*)((char*)memory + pos); 
+            next = bl->offset & ~FREE; 
+
+            return { (const char*)bl + sizeof(Block), bl->size, (bl->offset & FREE) != 0 }; 
+        }
+
+        #ifdef DEBUG 
+            inline size_t fast_block_size() const {
+                return sizeof(Block); 
+            }
+        #endif 
+
+        // a block with a mapping of its own, see LargeBlocks
+        void *map_large(const size_t size) {
+            void *x = large.map(size); 
+            if(!x) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            counters.alloc(LARGE_CLASS, large.size_of(x)); 
+            return x; 
+        }
+
+        // heap on a page aligned part of an already reserved range (MEM_SIZE bytes at mem). 
+        // large blocks are up to the owner of the range
+        MemAllocator(void *mem, const Arena &parent) : arena(parent, mem, MEM_SIZE), memory(mem), largeSize(SIZE_MAX), trimThreshold(SIZE_MAX) {}
+
     public:
 
-        MemAllocator() { get_memory(); }
-        ~MemAllocator() { munmap(memory, MEM_SIZE); }
+        MemAllocator(const MemOptions &opts = MemOptions()) 
+            : arena(MEM_SIZE, opts), memory(arena.base()), largeSize(LargeBlocks::threshold(opts.largeSize)), 
+              trimThreshold(opts.trimThreshold ? opts.trimThreshold : SIZE_MAX) {}
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out so far, free blocks below offset included
+        inline size_t mem_used() const { return offset.acquire(); }
+
+        // counters and per class totals, only used, reserved and the page options without TrackStats
+        MemStats stats() const {
+            MemStats s; 
+            counters.snapshot(s); 
+            s.used = offset.acquire(); 
+            s.reserved = MEM_SIZE; 
+            s.largeBlocks = large.size(); 
+            s.largeBytes = large.bytes(); 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
 
-        void *mem_alloc(const size_t size) {
-            Block *bl = get_block((size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size));
-            bl->free = NOT_FREE;
+        // every block from the first to offset, see HeapWalk
+        inline HeapWalk<MemAllocator> walk() const { return HeapWalk<MemAllocator>(*this); }
 
-            #ifdef TRACK_USE 
-                memAlloc++; 
-            #endif 
+        // walks the whole heap, O(blocks)
+        MemReport report() const {
+            MemReport r(offset, MEM_SIZE, SIZE_CLASS_NUM, sizeof(Block)); 
+            for(const HeapBlock &bl : walk()) 
+                r.add(bl, get_size_class(bl.size)); 
 
-            return ((char*)memory + bl->offset - bl->size); // user memory
+            r.finish(); 
+            return r; 
         }
 
-        void mem_free(const void *ptr) {
-            Block *bl = (Block*)((char*)ptr - sizeof(Block)); // ptr is where the data starts after the Block
-            bl->free = FREE;
+        void *mem_alloc(size_t size) {
+            if(size >= largeSize) 
+                return map_large(size); 
 
-            coalescing(bl);
-            add_block_to_class(bl); 
-            
-            #ifdef TRACK_USE 
-                memFree++; 
-            #endif 
+            Block *bl = get_block(adjust_size(size));
+
+            if(!bl) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            counters.alloc(get_size_class(bl->size), bl->size); 
+            return (char*)bl + sizeof(Block); // user memory
         }
-}; 
+     
+        bool mem_free(void *ptr) {
+            if(!ptr) 
+                return false; 
+
+            // mapped or foreign ptr
+            if(ptr < memory || ptr >= (char*)memory + offset) {
+                const size_t bytes = large.size_of(ptr); 
+                if(!bytes) 
+                    return false; 
+
+                counters.free(LARGE_CLASS, bytes); 
+                return large.unmap(ptr); 
+            }
+                
+            Block *bl = (Block*)((char*)ptr - sizeof(Block));
+
+            counters.free(get_size_class(bl->size), bl->size); 
+
+            // the top goes back to the bump region. FAST cant find the block in front, 
+            // free blocks that end up at the top stay where they are until mem_trim
+            if(bl->offset == offset) 
+                lower_top((char*)bl - (char*)memory); 
+            else {
+                add_block_to_class(bl); 
+
+                if(bl->size >= trimThreshold) 
+                    release_free(bl); 
+            }
+            
+            return true; 
+        }
+
+        // gives the pages the heap doesnt use back to the kernel: the free blocks at the top go back to the bump region, 
+        // then the insides of all free blocks and everything more than keep bytes past offset get released. 
+        // they read as zero and fault in again once reused. O(blocks), returns the bytes given back
+        size_t mem_trim(const size_t keep = 0) {
+            // end of the last block in use
+            size_t end = FIRST_BLOCK; 
+            for(size_t pos = FIRST_BLOCK; pos < offset;) {
+                const Block *bl = (Block*)((char*)memory + pos); 
+                pos = bl->offset & ~FREE; 
+
+                if(!(bl->offset & FREE)) 
+                    end = pos; 
+            }
+
+            for(size_t pos = end; pos < offset;) {
+                Block *bl = (Block*)((char*)memory + pos); 
+                pos = bl->offset & ~FREE; 
+                remove_block_from_class(bl, get_size_class(bl->size)); 
+            }
+
+            if(offset > peak) 
+                peak = offset; 
+
+            offset = end; 
+            size_t bytes = 0; 
+
+            if(keep < MEM_SIZE - offset) {
+                bytes = arena.release(offset + keep, SIZE_MAX); 
+                peak = (peak < offset + keep ? peak : offset + keep); 
+            }
+
+            for(Block *head : sizeClasses) 
+                for(Block *bl = head; bl; bl = links(bl)->next) 
+                    bytes += release_free(bl); 
+
+            return bytes; 
+        }
+
+
+        // payload bytes behind ptr, can be more than asked for. 0 for null or foreign ptrs
+        size_t mem_usable_size(const void *ptr) const {
+            if(!ptr) 
+                return 0; 
+
+            if(ptr < memory || ptr >= (char*)memory + offset.acquire()) 
+                return large.size_of(ptr); 
+
+            return ((const Block*)((const char*)ptr - sizeof(Block)))->size; 
+        }
+
+        // alignment has to be a power of two, anything up to ALIGNMENT is just mem_alloc
+        void *mem_alloc_aligned(size_t size, const size_t alignment) {
+            if(alignment <= ALIGNMENT) 
+                return mem_alloc(size); 
+
+            // mappings are page aligned
+            if(size >= largeSize && alignment <= LargeBlocks::PAGE && !(alignment & (alignment - 1))) 
+                return map_large(size); 
+
+            if((alignment & (alignment - 1)) || size > MEM_SIZE) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            size = adjust_size(size); 
+
+            // a free block with room for the biggest possible gap in front, 
+            // otherwise a new one thats exactly as big as the gap at offset needs
+            Block *bl = find_block(adjust_size(size + alignment + sizeof(Block) + MIN_BLOCK_SIZE)); 
+            if(!bl) {
+                char *payload = (char*)memory + offset + sizeof(Block); 
+                if(!(bl = create_block(aligned_payload(payload, alignment) - payload + size))) {
+                    counters.failed(); 
+                    return nullptr; 
+                }
+            }
+
+            bl = cut_front(bl, alignment); 
+            cut_tail(bl, size); 
+
+            counters.alloc(get_size_class(bl->size), bl->size); 
+
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        // n blocks of the same size, taken from their size class first and the rest in one run from the bump region.
+        // returns how many got allocated, less than n only when the arena is full
+        size_t mem_alloc_batch(size_t size, const size_t n, void **out) {
+            size = adjust_size(size); 
+            const uint8_t sizeClass = get_size_class(size); 
+            size_t amnt = 0; 
+
+            for(Block *bl = sizeClasses[sizeClass]; bl && amnt < n;) {
+                Block *next = links(bl)->next; 
+
+                if(bl->size >= size) {
+                    remove_block_from_class(bl, sizeClass); 
+                    out[amnt++] = (char*)bl + sizeof(Block); 
+                }
+
+                bl = next; 
+            }
+
+            amnt += create_run(size, n - amnt, out + amnt); 
+
+            if constexpr(STATS::ENABLED) 
+                for(size_t i = 0; i < amnt; i++) {
+                    const Block *bl = (Block*)((char*)out[i] - sizeof(Block)); 
+                    counters.alloc(get_size_class(bl->size), bl->size); 
+                }
+
+            return amnt; 
+        }
+
+        // chains the blocks up per size class and splices every chain in at once, returns how many got freed. 
+        // goes back to front, so a run from mem_alloc_batch freed in the same order goes back to the bump region whole
+        size_t mem_free_batch(void **ptrs, const size_t n) {
+            Block *heads[SIZE_CLASS_NUM] { nullptr }, 
+                  *tails[SIZE_CLASS_NUM] { nullptr }; 
+            size_t amnt = 0; 
+
+            for(size_t i = n; i-- > 0;) {
+                // null, mapped or foreign ptr, the top takes the same way as in mem_free
+                if(!ptrs[i] || ptrs[i] < memory || ptrs[i] >= (char*)memory + offset || 
+                   ((Block*)((char*)ptrs[i] - sizeof(Block)))->offset == offset) {
+                    amnt += mem_free(ptrs[i]); 
+                    continue; 
+                }
+
+                Block *bl = (Block*)((char*)ptrs[i] - sizeof(Block)); 
+                const uint8_t sizeClass = get_size_class(bl->size); 
+
+                if(bl->size >= trimThreshold) 
+                    release_free(bl); 
+
+                links(bl)->prev = tails[sizeClass]; 
+                links(bl)->next = nullptr; 
+
+                if(tails[sizeClass]) 
+                    links(tails[sizeClass])->next = bl; 
+                else 
+                    heads[sizeClass] = bl; 
+
+                tails[sizeClass] = bl; 
+                bl->offset |= FREE; 
+                amnt++; 
+
+                counters.free(sizeClass, bl->size); 
+                counters.listed(sizeClass, bl->size); 
+            }
+
+            for(uint8_t sizeClass = 0; sizeClass < SIZE_CLASS_NUM; sizeClass++) {
+                if(!heads[sizeClass]) 
+                    continue; 
+
+                Block *head = sizeClasses[sizeClass]; 
+                links(tails[sizeClass])->next = head; 
+
+                if(head != SIZE_CLASS_EMPTY) 
+                    links(head)->prev = tails[sizeClass]; 
+
+                sizeClasses[sizeClass] = heads[sizeClass]; 
+            }
+
+            return amnt; 
+        }
+
+
+        // shrinking gives the tail back, as a free block or to the bump region if bl is the top. 
+        // growing takes the free blocks behind and the bump region, otherwise any free block or a new one. 
+        // from largeSize on the block moves into its own mapping, where mremap grows it without copying
+        void *mem_realloc(void *ptr, size_t size) {
+            if(size == 0) {
+                mem_free(ptr); 
+                return nullptr; 
+            }
+
+            if(!ptr) 
+                return mem_alloc(size); 
+
+            // mapped block, or foreign ptr
+            if(ptr < memory || ptr >= (char*)memory + offset) {
+                const size_t oldBytes = large.size_of(ptr); 
+                if(!oldBytes) 
+                    return nullptr; 
+
+                void *x = large.remap(ptr, size); 
+                if(!x) {
+                    counters.failed(); 
+                    return nullptr; 
+                }
+
+                counters.resized(LARGE_CLASS, oldBytes, LARGE_CLASS, large.size_of(x)); 
+                return x; 
+            }
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            const size_t oldSize = bl->size; 
+
+            if(size >= largeSize) {
+                void *x = map_large(size); 
+                if(!x) 
+                    return nullptr; 
+
+                std::memcpy(x, ptr, (oldSize < size ? oldSize : size)); 
+                mem_free(ptr); 
+
+                return x; 
+            }
+
+            size = adjust_size(size); 
+
+            if(size <= bl->size) {
+                // the top just moves offset back
+                if(bl->offset == offset) {
+                    bl->offset -= bl->size - size; 
+                    lower_top(bl->offset); 
+                    bl->size = size; 
+                }
+                else 
+                    cut_tail(bl, size); 
+
+                counters.resized(get_size_class(oldSize), oldSize, get_size_class(bl->size), bl->size); 
+                return ptr; 
+            }
+
+            // grow into the free blocks right behind, FAST never merges them so there can be several. 
+            // if they reach up to offset, the bump region makes up for whatever is missing
+            size_t room = bl->size, 
+                   end = bl->offset; 
+
+            while(room < size && end != offset) {
+                const Block *nbl = (Block*)((char*)memory + end); 
+                if(!(nbl->offset & FREE)) 
+                    break; 
+
+                room += sizeof(Block) + nbl->size; 
+                end = nbl->offset & ~FREE; 
+            }
+
+            const bool bump = (room < size && end == offset && size - room <= MEM_SIZE - offset && arena.commit(offset + size - room)); 
+
+            if(room >= size || bump) {
+                for(size_t pos = bl->offset; pos != end;) {
+                    Block *nbl = (Block*)((char*)memory + pos); 
+                    pos = nbl->offset & ~FREE; 
+                    remove_block_from_class(nbl, get_size_class(nbl->size)); 
+                }
+
+                bl->size = room; 
+                bl->offset = end; 
+
+                if(bump) {
+                    offset += size - room; 
+                    bl->offset = offset; 
+                    bl->size = size; 
+                    counters.offset(offset); 
+                }
+                else 
+                    cut_tail(bl, size); 
+
+                counters.resized(get_size_class(oldSize), oldSize, get_size_class(bl->size), bl->size); 
+                return ptr; 
+            }
+
+            // realloc in a free block or a new one. a growing buffer leaves a trail of blocks too small for it 
+            // in the catch-all class, so only the most recently freed ones are looked at
+            Block *nbl = find_block(size, REALLOC_SCAN); 
+            if(!nbl && !(nbl = create_block(size))) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            counters.alloc(get_size_class(nbl->size), nbl->size); 
+            std::memcpy((char*)nbl + sizeof(Block), ptr, oldSize); 
+            mem_free(ptr); 
+
+            return (char*)nbl + sizeof(Block); 
+        }
+}; 
+
+
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<PRECISE, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+ 
+    private: 
+        #ifdef DEBUG 
+            friend class AllocAndFree; 
+        #endif 
+
+        template<typename> friend class HeapWalk; 
+
+        using Word = typename HEADER::Word; 
+
+        // offset is where the next block starts, its low bits hold FREE, PREV_FREE (block in front is free, 
+        // its boundary tag is valid) and CACHED (freed, but not merged yet). blocks are always a multiple of 8 apart
+        struct Block {
+            Word size, offset; 
+        };
+
+        // only free blocks have these, stored in their payload so live blocks dont pay for them
+        struct FreeLinks {
+            Block *prev, *next; 
+        };
+
+        // boundary tag, the last word of a free blocks payload holds where the block starts
+        using Tag = Word; 
+
+        // free blocks at least trimThreshold big keep the part that may still be resident right behind their links, 
+        // so mem_free gives pages back once trimThreshold of them piled up and never walks the released rest again
+        struct Unreleased {
+            size_t from, to; 
+        };
+        
+        static constexpr    uint8_t     SIZE_CLASS_NUM          = 20,
+                                        MIN_BLOCK_SIZE          = sizeof(FreeLinks) + sizeof(Tag);
+
+        static constexpr    size_t      FREE                    = 1, 
+                                        PREV_FREE               = 2, 
+                                        CACHED                  = 4, 
+                                        FLAGS                   = FREE | PREV_FREE | CACHED; 
+        
+        static constexpr    Block       *SIZE_CLASS_EMPTY       = nullptr;
+
+        static constexpr    uint8_t     LARGE_CLASS             = SIZE_CLASS_NUM - 1; 
+
+        // a free block that big has room for its Unreleased range
+        static constexpr    size_t      MIN_TRIM                = MIN_BLOCK_SIZE + sizeof(Unreleased); 
+
+        // first header sits so that its payload is aligned, every block (header + payload) is a multiple of ALIGNMENT
+        static constexpr    size_t      FIRST_BLOCK             = ((sizeof(Block) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+
+        static_assert(ALIGNMENT >= alignof(FreeLinks) && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, at least pointer sized"); 
+        static_assert(MEM_SIZE <= (Word)-1, "MEM_SIZE too big for CompactHeader"); 
+
+        Block *sizeClasses[SIZE_CLASS_NUM] { nullptr }; // contains only free Blocks
+        Block *cached[SIZE_CLASS_NUM] { nullptr };      // deferred frees, linked through links()->next. to their neighbours they still look in use
+        size_t cachedAmnt = 0; 
+        Arena arena; 
+        void *memory;
+        size_t offset = FIRST_BLOCK,
+               peak = FIRST_BLOCK;  // highest offset since the pages behind it were last given back
+        LargeBlocks large; 
+        const bool deferred;    // see MemOptions
+        const size_t largeSize, // see MemOptions
+                     trimThreshold; 
+        
+        STATS counters; // see stats()
+
+        inline uint8_t get_size_class(const size_t size) const {
+            if(size <= 4)           return 0; 
+            else if(size <= 8)      return 1;
+            else if(size <= 16)     return 2;
+            else if(size <= 32)     return 3;
+            else if(size <= 48)     return 4;
+            else if(size <= 64)     return 5;
+            else if(size <= 80)     return 6;
+            else if(size <= 96)     return 7;
+            else if(size <= 128)    return 8;
+            else if(size <= 160)    return 9;
+            else if(size <= 192)    return 10;
+            else if(size <= 256)    return 11;
+            else if(size <= 320)    return 12;
+            else if(size <= 384)    return 13;
+            else if(size <= 512)    return 14;
+            else if(size <= 640)    return 15;
+            else if(size <= 768)    return 16;
+            else if(size <= 896)    return 17;
+            else if(size <= 1024)   return 18;
+            else                    return 19;
+        }
+
+        // payload has to hold the free links and tag, and keep the next payload aligned
+        static inline size_t adjust_size(const size_t size) {
+            return ((sizeof(Block) + (size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+        }
+
+        static inline FreeLinks *links(Block *bl) { return (FreeLinks*)((char*)bl + sizeof(Block)); }
+
+        static inline size_t next_pos(const Block *bl) { return bl->offset & ~FLAGS; }
+        inline Block *next_block(const Block *bl) const { return (Block*)((char*)memory + next_pos(bl)); }
+
+        // moves the end of bl, its flags stay
+        static inline void set_next(Block *bl, const size_t pos) { bl->offset = pos | (bl->offset & FLAGS); }
+        
+        Block *create_block(const size_t size) {
+            // enough space to create new Block?
+            if(size + sizeof(Block) > MEM_SIZE - offset || !arena.commit(offset + sizeof(Block) + size)) 
+                return nullptr; 
+
+            Block *bl = (Block*)((char*)memory + offset); 
+
+            bl->size = size; 
+
+            offset += sizeof(Block) + size;
+            bl->offset = offset; // start pos of next block, no flags, the top is never free
+            
+            counters.offset(offset); 
+
+            return bl;
+        }
+
+        void remove_block_from_class(Block *bl, const uint8_t sizeClass) {
+            FreeLinks *l = links(bl); 
+
+            if(l->prev) 
+                links(l->prev)->next = l->next; 
+            else 
+                sizeClasses[sizeClass] = l->next; 
+
+            if(l->next) 
+                links(l->next)->prev = l->prev; 
+
+            // free blocks are never the top, there is always a block behind bl
+            next_block(bl)->offset &= ~PREV_FREE; 
+            
+            counters.unlisted(sizeClass, bl->size); 
+        }
+
+        void add_block_to_class(Block *bl) {
+            const uint8_t sizeClass = get_size_class(bl->size);
+            Block *head = sizeClasses[sizeClass]; 
+
+            links(bl)->prev = nullptr; 
+            links(bl)->next = head; 
+            
+            if(head != SIZE_CLASS_EMPTY) 
+                links(head)->prev = bl; 
+
+            sizeClasses[sizeClass] = bl;
+
+            // leave the tag for the block behind, so it can find bl when it gets freed
+            *(Tag*)((char*)next_block(bl) - sizeof(Tag)) = (char*)bl - (char*)memory; 
+            next_block(bl)->offset |= PREV_FREE; 
+            
+            counters.listed(sizeClass, bl->size); 
+        }   
+     
+        // k blocks of the same size back to back from the bump region, one bounds check and commit for all of them
+        size_t create_run(const size_t size, size_t k, void **out) {
+            const size_t step = sizeof(Block) + size; 
+
+            if(k > (MEM_SIZE - offset) / step) 
+                k = (MEM_SIZE - offset) / step; 
+
+            if(!arena.commit(offset + k * step)) 
+                return 0; 
+
+            for(size_t i = 0; i < k; i++) {
+                Block *bl = (Block*)((char*)memory + offset); 
+                bl->size = size; 
+
+                offset += step; 
+                bl->offset = offset; 
+
+                out[i] = (char*)bl + sizeof(Block); 
+            }
+
+            counters.offset(offset);  
+
+            return k; 
+        }
+
+        Block *split(Block *bl, const size_t size) {
+            if(bl->size < MIN_BLOCK_SIZE + sizeof(Block) + size) // block big enough to split? 
+                return nullptr; 
+
+            // remove bl from sizeClasses 
+            remove_block_from_class(bl, get_size_class(bl->size)); 
+            
+            // create and init nbl at the end of bl
+            Block *nbl = (Block*)((char*)next_block(bl) - (sizeof(Block) + size));
+            nbl->size = size; 
+            nbl->offset = next_pos(bl) | FREE;
+
+            // set new data for bl after splitting, the flags in the low bits stay
+            bl->size -= (sizeof(Block) + size); 
+            bl->offset -= (sizeof(Block) + size);
+            
+            // sort bl back into sizeClasses
+            add_block_to_class(bl); 
+            
+            counters.split();  
+            
+            return nbl;
+        }
+        
+        // merges bl with free neighbours on both sides, returns the merged block
+        Block *coalescing(Block* bl) {
+            // merge with the block behind, unless bl is the top
+            Block *nbl = next_block(bl);
+            if(next_pos(bl) != offset && (nbl->offset & FREE)) {
+                remove_block_from_class(nbl, get_size_class(nbl->size));
+                
+                set_next(bl, next_pos(nbl));
+                bl->size += sizeof(Block) + nbl->size;
+
+                counters.coalesce();  
+            }
+
+            // merge with the block in front, its tag sits right before our header
+            if(bl->offset & PREV_FREE) {
+                Block *pbl = (Block*)((char*)memory + *((Tag*)bl - 1)); 
+                remove_block_from_class(pbl, get_size_class(pbl->size));
+
+                set_next(pbl, next_pos(bl));
+                pbl->size += sizeof(Block) + bl->size;
+                bl = pbl; 
+
+                counters.coalesce();  
+            }
+
+            return bl; 
+        }
+
+        Block *first_fit(const size_t size) {
+            const uint8_t sizeClass = get_size_class(size); 
+            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
+                return nullptr; 
+            
+            Block *tmp = sizeClasses[sizeClass]; 
+
+            // look for valid Block
+            while(tmp != nullptr) {
+                if(tmp->size >= size) {
+                    remove_block_from_class(tmp, sizeClass); 
+                    return tmp; 
+                }
+
+                tmp = links(tmp)->next; 
+            }
+            
+            // no Block found
+            return nullptr;
+        }
+
+        Block *best_fit(const size_t size) {
+            const uint8_t sizeClass = get_size_class(size); 
+            if(sizeClasses[sizeClass] == SIZE_CLASS_EMPTY) 
+                return nullptr; 
+
+            Block *tmp = sizeClasses[sizeClass],
+                  *best = nullptr; 
+            
+            // look for valid Block
+            while(tmp != nullptr) {
+                if((best == nullptr || tmp->size < best->size) && tmp->size >= size) {
+                    best = tmp; 
+                    
+                    if(best->size == size)
+                        break; 
+                }
+
+                tmp = links(tmp)->next; 
+            }
+
+            // no Block found
+            if(best == nullptr)
+                return nullptr;
+
+            remove_block_from_class(best, sizeClass);
+            return best; 
+        }
+
+        // first address in a payload thats aligned and leaves either no gap or one big enough to be a free block
+        static inline char *aligned_payload(char *payload, const size_t alignment) {
+            char *p = (char*)(((uintptr_t)payload + alignment - 1) & ~(alignment - 1)); 
+
+            while(p != payload && (size_t)(p - payload) < sizeof(Block) + MIN_BLOCK_SIZE) 
+                p += alignment; 
+
+            return p; 
+        }
+
+        // moves the start of bl (in use) up until its payload is aligned, the gap in front gets freed
+        Block *cut_front(Block *bl, const size_t alignment) {
+            char *payload = (char*)bl + sizeof(Block), 
+                 *p = aligned_payload(payload, alignment); 
+
+            if(p == payload) 
+                return bl; 
+
+            Block *abl = (Block*)(p - sizeof(Block)); 
+            abl->size = bl->size - (p - payload); 
+            abl->offset = next_pos(bl); 
+
+            bl->size = (char*)abl - payload; 
+            set_next(bl, (char*)abl - (char*)memory); 
+            free_block(bl); 
+
+            return abl; 
+        }
+
+        // everything in bl (in use) past size gets freed
+        void cut_tail(Block *bl, const size_t size) {
+            if(bl->size < size + sizeof(Block) + MIN_BLOCK_SIZE) 
+                return; 
+
+            Block *tbl = (Block*)((char*)bl + sizeof(Block) + size); 
+            tbl->size = bl->size - size - sizeof(Block); 
+            tbl->offset = next_pos(bl); 
+
+            bl->size = size; 
+            set_next(bl, (char*)tbl - (char*)memory); 
+            free_block(tbl); 
+        }
+
+        // a free block for size, nullptr if the size classes have none
+        Block *find_block(const size_t size) {
+            Block *ret;
+            uint8_t sizeClass = get_size_class(size);
+
+            // the higher the sizeClass, the more the size can vary.
+            // for lower classes, with 4-32b flucatuation, first_fit is efficient enough,
+            // for higher classes, with 64-128b fluctuation, best_fit is used to reduce fragmentation
+            if(sizeClass <= 10) 
+                ret = first_fit(size);
+            else 
+                ret = best_fit(size);
+
+            // best -/ first_fit wasn't able to find a block
+            // look in higher sizeClasses for a Block to split
+            if(ret == nullptr) {
+                sizeClass = get_size_class(size * 2); 
+                for(; sizeClass < SIZE_CLASS_NUM; sizeClass++) {
+                    if(sizeClasses[sizeClass] != SIZE_CLASS_EMPTY) {
+                        ret = split(sizeClasses[sizeClass], size);
+                        
+                        if(ret != nullptr) 
+                            break;
+                    }
+                }
+            }
+            
+            return ret; 
+        }
+
+        // the latest cached block of the size class, if its big enough. only the head is looked at, 
+        // so a hit is O(1) and a miss falls through to the size classes
+        Block *from_cache(const size_t size) {
+            const uint8_t sizeClass = get_size_class(size); 
+            Block *bl = cached[sizeClass]; 
+
+            if(!bl || bl->size < size) 
+                return nullptr; 
+
+            cached[sizeClass] = links(bl)->next; 
+            cachedAmnt--; 
+            bl->offset &= ~CACHED; 
+
+            counters.unlisted(sizeClass, bl->size); 
+
+            return bl; 
+        }
+
+        void add_block_to_cache(Block *bl) {
+            const uint8_t sizeClass = get_size_class(bl->size); 
+
+            bl->offset |= CACHED; 
+            links(bl)->next = cached[sizeClass]; 
+            cached[sizeClass] = bl; 
+            cachedAmnt++; 
+
+            counters.listed(sizeClass, bl->size); 
+        }
+
+        // find_block, but a miss merges the cache first and looks again
+        Block *find_merged(const size_t size) {
+            Block *ret = find_block(size); 
+
+            if(!ret && cachedAmnt) {
+                compact(); 
+                ret = find_block(size); 
+            }
+
+            return ret; 
+        }
+
+        Block *get_block(const size_t size) {
+            Block *ret = (cachedAmnt ? from_cache(size) : nullptr); 
+
+            if(!ret) 
+                ret = find_merged(size); 
+
+            // if best/first_fit & splitting failed, create a new block
+            return (ret ? ret : create_block(size));
+        }
+
+        void free_block(Block *bl) {
+            const size_t pos = (char*)bl - (char*)memory, 
+                         end = next_pos(bl); 
+
+            bl->offset |= FREE;
+            bl = coalescing(bl);
+
+            // bl is the top now, hand it back to the bump region
+            if(next_pos(bl) == offset) {
+                lower_top((char*)bl - (char*)memory); 
+                return; 
+            }
+
+            add_block_to_class(bl); 
+
+            if(bl->size < trimThreshold) 
+                return; 
+
+            // this free and what the merged neighbours still have resident, the released rest isnt touched again
+            const size_t start = (char*)bl - (char*)memory, 
+                         stop = next_pos(bl); 
+            size_t from = pos, to = end, f, t; 
+
+            if(start < pos) {
+                unreleased(start, pos, f, t); 
+                if(f < t) 
+                    from = f; 
+            }
+
+            if(end < stop) {
+                unreleased(end, stop, f, t); 
+                if(f < t) 
+                    to = t; 
+            }
+
+            if(to - from >= trimThreshold) {
+                release_free(bl, from, to); 
+                from = to = pos; 
+            }
+
+            *unreleased(bl) = { from, to }; 
+        }
+
+        // offset moves back to pos, once trimThreshold bytes behind it are unused their pages go back to the kernel
+        void lower_top(const size_t pos) {
+            if(offset > peak) 
+                peak = offset; 
+
+            offset = pos; 
+
+            if(peak - offset >= trimThreshold) {
+                arena.release(offset, peak); 
+                peak = offset; 
+            }
+        }
+
+        static inline Unreleased *unreleased(Block *bl) { return (Unreleased*)((char*)bl + sizeof(Block) + sizeof(FreeLinks)); }
+
+        // [from, to) of the free block that was [pos, end) and may still be resident, empty once all of it went back. 
+        // smaller ones never got tracked and a range that doesnt fit is left over from the payload, then all of it counts
+        inline void unreleased(const size_t pos, const size_t end, size_t &from, size_t &to) {
+            from = pos; 
+            to = end; 
+
+            if(end - pos - sizeof(Block) < trimThreshold) 
+                return; 
+
+            const Unreleased u = *unreleased((Block*)((char*)memory + pos)); 
+            if(u.from >= pos && u.from <= u.to && u.to <= end) {
+                from = u.from; 
+                to = u.to; 
+            }
+        }
+
+        // the whole pages of [from, to) inside a free blocks payload, its links, the unreleased range and the tag stay
+        inline size_t release_free(Block *bl, size_t from = 0, size_t to = SIZE_MAX) {
+            const size_t payload = (char*)bl + sizeof(Block) - (char*)memory; 
+
+            if(from < payload + sizeof(FreeLinks) + sizeof(Unreleased)) 
+                from = payload + sizeof(FreeLinks) + sizeof(Unreleased); 
+
+            if(to > payload + bl->size - sizeof(Tag)) 
+                to = payload + bl->size - sizeof(Tag); 
+
+            return arena.release(from, to); 
+        }
+
+        // header at pos as a heap walk sees it, next is where the block behind it starts
+        inline HeapBlock block_at(const size_t pos, size_t &next) const {
+            const Block *bl = (const Block*)((char*)memory + pos); 
+            next = next_pos(bl); 
+
+            return { (const char*)bl + sizeof(Block), bl->size, (bl->offset & (FREE | CACHED)) != 0 }; 
+        }
+
+        // a block with a mapping of its own, see LargeBlocks
+        void *map_large(const size_t size) {
+            void *x = large.map(size); 
+            if(!x) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            counters.alloc(LARGE_CLASS, large.size_of(x)); 
+            return x; 
+        }
+
+    public:
+
+        MemAllocator(const MemOptions &opts = MemOptions()) 
+            : arena(MEM_SIZE, opts), memory(arena.base()), deferred(opts.deferCoalescing), largeSize(LargeBlocks::threshold(opts.largeSize)), 
+              trimThreshold(!opts.trimThreshold ? SIZE_MAX : opts.trimThreshold < MIN_TRIM ? MIN_TRIM : opts.trimThreshold) {}
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out so far, free blocks below offset included
+        inline size_t mem_used() const { return offset; }
+
+        // counters and per class totals, only used, reserved and the page options without TrackStats
+        MemStats stats() const {
+            MemStats s; 
+            counters.snapshot(s); 
+            s.used = offset; 
+            s.reserved = MEM_SIZE; 
+            s.largeBlocks = large.size(); 
+            s.largeBytes = large.bytes(); 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        // every block from the first to offset, see HeapWalk
+        inline HeapWalk<MemAllocator> walk() const { return HeapWalk<MemAllocator>(*this); }
+
+        // walks the whole heap, O(blocks)
+        MemReport report() const {
+            MemReport r(offset, MEM_SIZE, SIZE_CLASS_NUM, sizeof(Block)); 
+            for(const HeapBlock &bl : walk()) 
+                r.add(bl, get_size_class(bl.size)); 
+
+            r.finish(); 
+            return r; 
+        }
+
+        void *mem_alloc(const size_t size) {
+            if(size >= largeSize) 
+                return map_large(size); 
+
+            Block *bl = get_block(adjust_size(size));
+
+            if(!bl) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            bl->offset &= ~FREE;
+            counters.alloc(get_size_class(bl->size), bl->size); 
+
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        bool mem_free(const void *ptr) {
+            if(!ptr) 
+                return false; 
+
+            // mapped or foreign ptr
+            if(ptr < memory || ptr >= (char*)memory + offset) {
+                const size_t bytes = large.size_of(ptr); 
+                if(!bytes) 
+                    return false; 
+
+                counters.free(LARGE_CLASS, bytes); 
+                return large.unmap((void*)ptr); 
+            }
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); // ptr is where the data starts after the Block
+
+            counters.free(get_size_class(bl->size), bl->size); 
+
+            if(deferred) 
+                add_block_to_cache(bl); 
+            else 
+                free_block(bl); 
+
+            return true; 
+        }
+
+        // merges every cached block with its free neighbours and sorts it into the size classes, 
+        // blocks at the top go back to the bump region. nothing to do without MemOptions::deferCoalescing.
+        // runs on its own when an alloc misses, call it in idle time to keep that off the alloc path. 
+        // returns how many blocks got merged, O(cached blocks)
+        size_t compact() {
+            const size_t amnt = cachedAmnt; 
+
+            for(uint8_t sizeClass = 0; sizeClass < SIZE_CLASS_NUM; sizeClass++) 
+                while(Block *bl = cached[sizeClass]) {
+                    cached[sizeClass] = links(bl)->next; 
+                    bl->offset &= ~CACHED; 
+
+                    counters.unlisted(sizeClass, bl->size); 
+                    free_block(bl); 
+                }
+
+            cachedAmnt = 0; 
+            return amnt; 
+        }
+
+        // gives the pages the heap doesnt use back to the kernel: cached blocks get merged first, so the ones at the top 
+        // go back to the bump region, then the insides of all free blocks and everything more than keep bytes past offset 
+        // get released. they read as zero and fault in again once reused. O(free blocks), returns the bytes given back
+        size_t mem_trim(const size_t keep = 0) {
+            compact(); 
+
+            if(offset > peak) 
+                peak = offset; 
+
+            size_t bytes = 0; 
+
+            if(keep < MEM_SIZE - offset) {
+                bytes = arena.release(offset + keep, SIZE_MAX); 
+                peak = (peak < offset + keep ? peak : offset + keep); 
+            }
+
+            for(Block *head : sizeClasses) 
+                for(Block *bl = head; bl; bl = links(bl)->next) {
+                    bytes += release_free(bl); 
+
+                    if(bl->size >= trimThreshold) {
+                        const size_t pos = (char*)bl - (char*)memory; 
+                        *unreleased(bl) = { pos, pos }; 
+                    }
+                }
+
+            return bytes; 
+        }
+
+        // payload bytes behind ptr, can be more than asked for. 0 for null or foreign ptrs
+        size_t mem_usable_size(const void *ptr) const {
+            if(!ptr) 
+                return 0; 
+
+            if(ptr < memory || ptr >= (char*)memory + offset) 
+                return large.size_of(ptr); 
+
+            return ((const Block*)((const char*)ptr - sizeof(Block)))->size; 
+        }
+
+        // alignment has to be a power of two, anything up to ALIGNMENT is just mem_alloc
+        void *mem_alloc_aligned(size_t size, const size_t alignment) {
+            if(alignment <= ALIGNMENT) 
+                return mem_alloc(size); 
+
+            // mappings are page aligned
+            if(size >= largeSize && alignment <= LargeBlocks::PAGE && !(alignment & (alignment - 1))) 
+                return map_large(size); 
+
+            if((alignment & (alignment - 1)) || size > MEM_SIZE) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            size = adjust_size(size); 
+
+            // a free block with room for the biggest possible gap in front, 
+            // otherwise a new one thats exactly as big as the gap at offset needs
+            Block *bl = find_merged(adjust_size(size + alignment + sizeof(Block) + MIN_BLOCK_SIZE)); 
+            if(!bl) {
+                char *payload = (char*)memory + offset + sizeof(Block); 
+                if(!(bl = create_block(aligned_payload(payload, alignment) - payload + size))) {
+                    counters.failed(); 
+                    return nullptr; 
+                }
+            }
+
+            bl->offset &= ~FREE; 
+            bl = cut_front(bl, alignment); 
+            cut_tail(bl, size); 
+
+            counters.alloc(get_size_class(bl->size), bl->size); 
+
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        // n blocks of the same size, taken from their size class first and the rest in one run from the bump region.
+        // returns how many got allocated, less than n only when the arena is full
+        size_t mem_alloc_batch(size_t size, const size_t n, void **out) {
+            size = adjust_size(size); 
+            const uint8_t sizeClass = get_size_class(size); 
+            size_t amnt = 0; 
+
+            while(amnt < n && cachedAmnt) {
+                Block *bl = from_cache(size); 
+                if(!bl) 
+                    break; 
+
+                out[amnt++] = (char*)bl + sizeof(Block); 
+            }
+
+            for(Block *bl = sizeClasses[sizeClass]; bl && amnt < n;) {
+                Block *next = links(bl)->next; 
+
+                if(bl->size >= size) {
+                    remove_block_from_class(bl, sizeClass); 
+                    bl->offset &= ~FREE; 
+                    out[amnt++] = (char*)bl + sizeof(Block); 
+                }
+
+                bl = next; 
+            }
+
+            amnt += create_run(size, n - amnt, out + amnt); 
+
+            if constexpr(STATS::ENABLED) 
+                for(size_t i = 0; i < amnt; i++) {
+                    const Block *bl = (Block*)((char*)out[i] - sizeof(Block)); 
+                    counters.alloc(get_size_class(bl->size), bl->size); 
+                }
+
+            return amnt; 
+        }
+
+        // blocks that lie back to back in ptrs (like a run from mem_alloc_batch) get joined first 
+        // and go through coalescing as one block, also with deferCoalescing. returns how many got freed
+        size_t mem_free_batch(void **ptrs, const size_t n) {
+            size_t amnt = 0; 
+
+            for(size_t i = 0; i < n;) {
+                // null, mapped or foreign ptr
+                if(!ptrs[i] || ptrs[i] < memory || ptrs[i] >= (char*)memory + offset) {
+                    amnt += mem_free(ptrs[i++]); 
+                    continue; 
+                }
+
+                Block *bl = (Block*)((char*)ptrs[i++] - sizeof(Block)); 
+                counters.free(get_size_class(bl->size), bl->size); 
+                amnt++; 
+
+                while(i < n && ptrs[i] == (char*)next_block(bl) + sizeof(Block) && next_pos(bl) != offset) {
+                    Block *nbl = next_block(bl); 
+                    counters.free(get_size_class(nbl->size), nbl->size); 
+                    counters.coalesce(); 
+
+                    bl->size += sizeof(Block) + nbl->size; 
+                    set_next(bl, next_pos(nbl)); 
+
+                    i++; 
+                    amnt++; 
+                }
+
+                free_block(bl); 
+            }
+
+            return amnt; 
+        }
+
+        // shrinking cuts the tail off as a free block. growing takes the free block behind or the bump region 
+        // if bl is the top, only if neither has the room the data gets copied into a new block. 
+        // from largeSize on the block moves into its own mapping, where mremap grows it without copying
+        void *mem_realloc(void *ptr, size_t size) {
+            if(size == 0) {
+                mem_free(ptr); 
+                return nullptr; 
+            }
+
+            if(!ptr) 
+                return mem_alloc(size); 
+
+            // mapped block, or foreign ptr
+            if(ptr < memory || ptr >= (char*)memory + offset) {
+                const size_t oldBytes = large.size_of(ptr); 
+                if(!oldBytes) 
+                    return nullptr; 
+
+                void *x = large.remap(ptr, size); 
+                if(!x) {
+                    counters.failed(); 
+                    return nullptr; 
+                }
+
+                counters.resized(LARGE_CLASS, oldBytes, LARGE_CLASS, large.size_of(x)); 
+                return x; 
+            }
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            const size_t oldSize = bl->size; 
+
+            if(size >= largeSize) {
+                void *x = map_large(size); 
+                if(!x) 
+                    return nullptr; 
+
+                std::memcpy(x, ptr, (oldSize < size ? oldSize : size)); 
+                mem_free(ptr); 
+
+                return x; 
+            }
+
+            if(size > MEM_SIZE) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            size = adjust_size(size); 
+
+            // shrink in place, a tail at the top goes back to the bump region
+            if(size <= bl->size) {
+                cut_tail(bl, size); 
+                counters.resized(get_size_class(oldSize), oldSize, get_size_class(bl->size), bl->size); 
+
+                return ptr; 
+            }
+
+            // grow into the bump region
+            if(next_pos(bl) == offset) {
+                const size_t grow = size - bl->size; 
+
+                if(grow <= MEM_SIZE - offset && arena.commit(offset + grow)) {
+                    offset += grow; 
+                    set_next(bl, offset); 
+                    bl->size = size; 
+
+                    counters.offset(offset); 
+                    counters.resized(get_size_class(oldSize), oldSize, get_size_class(size), size); 
+
+                    return ptr; 
+                }
+            }
+            // grow into the free block behind, whatever is left of it stays free
+            else {
+                Block *nbl = next_block(bl); 
+
+                if((nbl->offset & FREE) && bl->size + sizeof(Block) + nbl->size >= size) {
+                    remove_block_from_class(nbl, get_size_class(nbl->size)); 
+
+                    bl->size += sizeof(Block) + nbl->size; 
+                    set_next(bl, next_pos(nbl)); 
+                    counters.coalesce(); 
+
+                    cut_tail(bl, size); 
+                    counters.resized(get_size_class(oldSize), oldSize, get_size_class(bl->size), bl->size); 
+
+                    return ptr; 
+                }
+            }
+
+            // realloc in new block
+            void *x = mem_alloc(size); 
+            if(!x) 
+                return nullptr; 
+
+            std::memcpy(x, ptr, oldSize); 
+            mem_free(ptr); 
+
+            return x; 
+        }
+}; 
+
+
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<THREADED, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class ThreadedHeaps; 
+        #endif 
+
+        static constexpr    uint8_t     MAX_THREADS             = 64; 
+        static constexpr    size_t      HEAP_SIZE               = (MEM_SIZE / MAX_THREADS) & ~(size_t)4095; // page aligned slice per thread
+
+        static_assert(HEAP_SIZE > 0, "MEM_SIZE too small to give every thread its own heap"); 
+
+        using Heap  = MemAllocator<FAST, HEAP_SIZE, ALIGNMENT, STATS, HEADER>; 
+        using Block = typename Heap::Block; 
+
+        // one heap per thread, padded to a cache line so the owners dont fight over it
+        struct alignas(64) Slot {
+            std::atomic<std::thread::id>    owner       { std::thread::id() };  
+            std::atomic<void*>              remoteFree  { nullptr };            // blocks freed by other threads, drained by the owner
+            std::atomic<Heap*>              heap        { nullptr };            // built by the first owner, stats() reads it from any thread
+            alignas(Heap) char              storage[sizeof(Heap)]; 
+        };
+
+        // the slot this thread used last, so we dont search the slots on every call
+        struct ThreadCache {
+            uint64_t    instance; 
+            Slot        *slot; 
+        };
+
+        // a thread that claimed a heap gives it back on exit, in every instance thats still alive. 
+        // instances are listed, so an exiting thread never touches one that was destroyed in between
+        struct ExitGuard {
+            bool armed = false; 
+
+            ~ExitGuard() {
+                if(!armed) 
+                    return; 
+
+                std::lock_guard<std::mutex> l(liveLock); 
+                for(MemAllocator *m = liveHead; m; m = m->nextLive) 
+                    m->release_thread_heap(); 
+            }
+        };
+
+        static inline std::atomic<uint64_t>     instances   { 0 }; 
+        static inline thread_local ThreadCache  cache       { 0, nullptr }; 
+        static inline thread_local ExitGuard    exitGuard; 
+        static inline std::mutex                liveLock; 
+        static inline MemAllocator              *liveHead   = nullptr; 
+
+        Slot slots[MAX_THREADS]; 
+        Arena arena; // only reserves, every heap commits its own slice
+        void *memory; 
+        const uint64_t id = ++instances; // 0 is never used, an empty cache never matches
+        MemAllocator *prevLive = nullptr, 
+                     *nextLive = nullptr; 
+
+        // large blocks dont belong to a heap, any thread may free them, so they share one table
+        LargeBlocks large; 
+        std::mutex largeLock; 
+        const size_t largeSize; // see MemOptions
+
+        inline bool owns(const void *ptr) const {
+            return ptr >= memory && ptr < (char*)memory + MAX_THREADS * HEAP_SIZE; 
+        }
+
+        // acquire, so a thread that didnt build the heap sees it whole
+        static inline Heap *heap_of(const Slot &s) { return s.heap.load(std::memory_order_acquire); }
+
+        inline Slot *slot_of(const void *ptr) {
+            return &slots[((char*)ptr - (char*)memory) / HEAP_SIZE]; 
+        }
+
+        void *map_large(const size_t size) {
+            std::lock_guard<std::mutex> l(largeLock); 
+            return large.map(size); 
+        }
+
+        inline Slot *remember(Slot *s) {
+            cache = { id, s }; 
+            return s; 
+        }
+
+        Slot *thread_slot() {
+            if(cache.instance == id) 
+                return cache.slot; 
+
+            const std::thread::id self = std::this_thread::get_id(); 
+
+            // this thread already has a heap, it just used another instance in between 
+            for(Slot &s : slots) 
+                if(s.owner.load(std::memory_order_relaxed) == self) 
+                    return remember(&s); 
+
+            return claim_slot(); 
+        }
+
+        // the first unowned heap, a released heap keeps its free lists. nullptr with more threads than heaps
+        Slot *claim_slot() {
+            const std::thread::id self = std::this_thread::get_id(); 
+
+            for(Slot &s : slots) {
+                std::thread::id none; 
+                if(!s.owner.compare_exchange_strong(none, self, std::memory_order_acquire, std::memory_order_relaxed)) 
+                    continue; 
+
+                if(!heap_of(s)) 
+                    s.heap.store(new(s.storage) Heap((char*)memory + (&s - slots) * HEAP_SIZE, arena), std::memory_order_release); 
+
+                exitGuard.armed = true; 
+                return remember(&s); 
+            }
+
+            return nullptr; 
+        }
+
+        // hand everything other threads freed back to the heap in one go
+        void drain_remote(Slot *s) {
+            void *ptr = s->remoteFree.exchange(nullptr, std::memory_order_acquire); 
+
+            while(ptr) {
+                void *next = *(void**)ptr; // mem_free overwrites the payload
+                heap_of(*s)->mem_free(ptr); 
+                ptr = next; 
+            }
+        }
+
+    public: 
+
+        MemAllocator(const MemOptions &opts = MemOptions()) 
+            : arena(MEM_SIZE, opts), memory(arena.base()), largeSize(LargeBlocks::threshold(opts.largeSize)) {
+            std::lock_guard<std::mutex> l(liveLock); 
+            nextLive = liveHead; 
+            if(liveHead) 
+                liveHead->prevLive = this; 
+
+            liveHead = this; 
+        }
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes every heap handed out so far, free blocks below their offset included. only exact while no other thread allocates
+        size_t mem_used() const {
+            size_t used = 0; 
+            for(const Slot &s : slots) 
+                if(const Heap *h = heap_of(s)) 
+                    used += h->mem_used(); 
+
+            return used; 
+        }
+
+        // every heap summed up, same caveat as mem_used(). blocks freed by other threads count once their owner drained them
+        MemStats stats() {
+            MemStats st; 
+            for(const Slot &s : slots) 
+                if(const Heap *h = heap_of(s)) 
+                    st += h->stats(); 
+
+            {
+                std::lock_guard<std::mutex> l(largeLock); 
+                st.largeBlocks = large.size(); 
+                st.largeBytes = large.bytes(); 
+            }
+
+            st.reserved = MEM_SIZE; 
+            st.pages = arena.pages(); 
+            st.prefaulted = arena.prefaulted(); 
+
+            return st; 
+        }
+        ~MemAllocator() {
+            {
+                std::lock_guard<std::mutex> l(liveLock); 
+                (prevLive ? prevLive->nextLive : liveHead) = nextLive; 
+                if(nextLive) 
+                    nextLive->prevLive = prevLive; 
+            }
+
+            for(Slot &s : slots) 
+                if(Heap *h = heap_of(s)) 
+                    h->~Heap(); 
+        }
+
+        void *mem_alloc(size_t size) {
+            if(size >= largeSize) 
+                return map_large(size); 
+
+            Slot *s = thread_slot(); 
+            if(!s) 
+                return nullptr; 
+
+            if(s->remoteFree.load(std::memory_order_relaxed)) 
+                drain_remote(s); 
+
+            // a heap taken over from an exited thread may be full already, then this thread takes one more
+            void *ptr = heap_of(*s)->mem_alloc(size); 
+            while(!ptr && (s = claim_slot())) 
+                ptr = heap_of(*s)->mem_alloc(size); 
+
+            return ptr; 
+        }
+
+        void *mem_alloc_aligned(size_t size, const size_t alignment) {
+            // mappings are page aligned
+            if(size >= largeSize && alignment <= LargeBlocks::PAGE && !(alignment & (alignment - 1))) 
+                return map_large(size); 
+
+            Slot *s = thread_slot(); 
+            if(!s) 
+                return nullptr; 
+
+            if(s->remoteFree.load(std::memory_order_relaxed)) 
+                drain_remote(s); 
+
+            void *ptr = heap_of(*s)->mem_alloc_aligned(size, alignment); 
+            while(!ptr && (s = claim_slot())) 
+                ptr = heap_of(*s)->mem_alloc_aligned(size, alignment); 
+
+            return ptr; 
+        }
+
+        bool mem_free(void *ptr) {
+            if(!ptr) 
+                return false; 
+
+            // mapped or foreign ptr
+            if(!owns(ptr)) {
+                std::lock_guard<std::mutex> l(largeLock); 
+                return large.unmap(ptr); 
+            }
+
+            Slot *s = slot_of(ptr); 
+            if(s->owner.load(std::memory_order_relaxed) == std::this_thread::get_id()) 
+                return heap_of(*s)->mem_free(ptr); 
+
+            // not our block, push it onto the owners remote list, linked through the payload
+            void *&next = *(void**)ptr; 
+            next = s->remoteFree.load(std::memory_order_relaxed); 
+            while(!s->remoteFree.compare_exchange_weak(next, ptr, std::memory_order_release, std::memory_order_relaxed)); 
+
+            return true; 
+        }
+
+        // blocks dont move between heaps, so any thread can ask
+        size_t mem_usable_size(const void *ptr) {
+            if(ptr && !owns(ptr)) {
+                std::lock_guard<std::mutex> l(largeLock); 
+                return large.size_of(ptr); 
+            }
+
+            const Heap *h = (ptr ? heap_of(*slot_of(ptr)) : nullptr); 
+            return (h ? h->mem_usable_size(ptr) : 0); 
+        }
+
+        void *mem_realloc(void *ptr, size_t size) {
+            if(!ptr) 
+                return mem_alloc(size); 
+
+            if(size == 0) {
+                mem_free(ptr); 
+                return nullptr; 
+            }
+
+            // mapped block, or foreign ptr
+            if(!owns(ptr)) {
+                std::lock_guard<std::mutex> l(largeLock); 
+                return large.remap(ptr, size); 
+            }
+
+            Slot *s = thread_slot(); 
+            if(s && slot_of(ptr) == s && size < largeSize) 
+                return heap_of(*s)->mem_realloc(ptr, size); 
+
+            // the block lives in another threads heap or gets too big for one, move it
+            void *nptr = mem_alloc(size); 
+            if(!nptr) 
+                return nullptr; 
+
+            const size_t oldSize = ((Block*)((char*)ptr - sizeof(Block)))->size; 
+            std::memcpy(nptr, ptr, (oldSize < size ? oldSize : size)); 
+            mem_free(ptr); 
+
+            return nptr; 
+        }
+
+        // gives this threads heap back, the next new thread takes it over with everything still in it. 
+        // happens on its own when the thread exits, calling it earlier frees the slot for others sooner
+        void release_thread_heap() {
+            const std::thread::id self = std::this_thread::get_id(); 
+
+            for(Slot &s : slots) {
+                if(s.owner.load(std::memory_order_relaxed) != self) 
+                    continue; 
+
+                drain_remote(&s); 
+                s.owner.store(std::thread::id(), std::memory_order_release); 
+            }
+
+            if(cache.instance == id) 
+                cache = { 0, nullptr }; 
+        }
+}; 
+
+
+// FAST shared by all threads without a lock. blocks migrate freely, any thread frees any block. 
+// every size class is a set of lock-free stacks (Treiber), a head packs a 32 bit tag next to the top block, 
+// so a pop racing with a pop + push of the same block fails its CAS instead of linking a stale next (ABA). 
+// the bump region is claimed with fetch_add. split and coalescing cant be made safe without locking both 
+// neighbours, so blocks never change their size: every size rounds up to its class and a block stays in it. 
+// the classes are ALIGNMENT steps up to 8 * ALIGNMENT and 4 per power of two after that, a block is at most 25% too big
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<CONCURRENT, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class ConcurrentHeap; 
+        #endif 
+
+        struct Block {
+            size_t size; // payload, the class size minus the header
+        };
+
+        using Link = std::atomic<uint32_t>; // first word of a free payload, the next block in the stack
+
+        static constexpr uint8_t floor_log2(const size_t x) { return 63 - __builtin_clzll(x); }
+
+        static constexpr    size_t      SMALL_CLASSES           = 8, 
+                                        SMALL_LOG2              = floor_log2(SMALL_CLASSES * ALIGNMENT), 
+                                        SHARD_NUM               = 8;            // stacks per class, threads start at their own
+
+        static constexpr    uint32_t    EMPTY                   = UINT32_MAX; 
+
+        // class of a whole block, header included
+        static constexpr size_t class_of(const size_t bytes) {
+            if(bytes <= SMALL_CLASSES * ALIGNMENT) 
+                return (bytes - 1) / ALIGNMENT; 
+
+            const size_t s = bytes - 1; 
+            const uint8_t e = floor_log2(s); 
+
+            return SMALL_CLASSES + (e - SMALL_LOG2) * 4 + ((s >> (e - 2)) & 3); 
+        }
+
+        static constexpr size_t class_size(const size_t c) {
+            if(c < SMALL_CLASSES) 
+                return (c + 1) * ALIGNMENT; 
+
+            const size_t e = SMALL_LOG2 + (c - SMALL_CLASSES) / 4; 
+            return ((size_t)1 << e) + ((c - SMALL_CLASSES) % 4 + 1) * ((size_t)1 << (e - 2)); 
+        }
+
+        static constexpr    size_t      CLASS_NUM               = class_of(MEM_SIZE) + 1, 
+                                        FIRST_BLOCK             = ALIGNMENT - sizeof(Block); 
+
+        static_assert(ALIGNMENT >= 8 && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, at least 8"); 
+        static_assert(MEM_SIZE / 8 < EMPTY, "CONCURRENT addresses blocks in 8b units with 32 bits, MEM_SIZE has to stay under 32GB"); 
+        static_assert(!STATS::ENABLED, "TrackStats counts with plain adds, it needs one writer at a time"); 
+        static_assert(std::is_same<HEADER, WideHeader>::value, "CONCURRENT keeps its own header layout"); 
+
+        // tag << 32 | block position / 8, on its own cache line so the stacks dont fight over it
+        struct alignas(64) Head {
+            std::atomic<uint64_t> top { EMPTY }; 
+        }; 
+
+        Head heads[CLASS_NUM][SHARD_NUM]; 
+        Arena arena; 
+        void *memory; 
+        std::atomic<size_t> offset { FIRST_BLOCK }; 
+
+        static inline std::atomic<uint8_t>      nextShard   { 0 }; 
+        static inline thread_local uint8_t      shard       = nextShard++ % SHARD_NUM; 
+
+        inline Block *block_at(const uint32_t idx) const { return (Block*)((char*)memory + (size_t)idx * 8); }
+        inline uint32_t index_of(const Block *bl) const { return ((char*)bl - (char*)memory) / 8; }
+        static inline Link *link(Block *bl) { return (Link*)((char*)bl + sizeof(Block)); }
+
+        void push(Head &h, Block *bl) {
+            const uint32_t idx = index_of(bl); 
+            uint64_t top = h.top.load(std::memory_order_relaxed); 
+
+            do {
+                link(bl)->store((uint32_t)top, std::memory_order_relaxed); 
+            } while(!h.top.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | idx, std::memory_order_release, std::memory_order_relaxed)); 
+        }
+
+        // the link of top may be rewritten by whoever popped it meanwhile, the tag makes the CAS fail then. 
+        // the arena is never unmapped, so reading a stale link is always safe
+        Block *pop(Head &h) {
+            uint64_t top = h.top.load(std::memory_order_acquire); 
+
+            while((uint32_t)top != EMPTY) {
+                Block *bl = block_at((uint32_t)top); 
+                const uint32_t next = link(bl)->load(std::memory_order_relaxed); 
+
+                if(h.top.compare_exchange_weak(top, ((top >> 32) + 1) << 32 | next, std::memory_order_acquire, std::memory_order_acquire)) 
+                    return bl; 
+            }
+
+            return nullptr; 
+        }
+
+        // own stack first, then the others before the bump region
+        Block *pop_class(const size_t c) {
+            for(size_t i = 0; i < SHARD_NUM; i++) 
+                if(Block *bl = pop(heads[c][(shard + i) % SHARD_NUM])) 
+                    return bl; 
+
+            return nullptr; 
+        }
+
+        Block *create_block(const size_t bytes) {
+            const size_t pos = offset.fetch_add(bytes, std::memory_order_relaxed); 
+
+            if(pos + bytes > MEM_SIZE) {
+                // give the claim back unless someone bumped behind it, then the rest of the arena is lost
+                size_t expected = pos + bytes; 
+                offset.compare_exchange_strong(expected, pos, std::memory_order_relaxed); 
+                return nullptr; 
+            }
+
+            return (Block*)((char*)memory + pos); 
+        }
+
+    public: 
+
+        // the whole range gets committed up front, so no thread ever has to grow it. pages are still only backed once touched
+        MemAllocator(const MemOptions &opts = MemOptions()) : arena(MEM_SIZE, opts), memory(arena.base()) {
+            if(!arena.commit(MEM_SIZE)) {
+                perror("mprotect"); 
+                exit(1); 
+            }
+        }
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out so far, free blocks included
+        inline size_t mem_used() const { 
+            const size_t off = offset.load(std::memory_order_relaxed); 
+            return (off < MEM_SIZE ? off : MEM_SIZE); 
+        }
+
+        inline bool owns(const void *ptr) const { return ptr > memory && ptr < (char*)memory + mem_used(); }
+
+        // only used, reserved and the page options, see the STATS static_assert
+        MemStats stats() const {
+            MemStats s; 
+            s.used = mem_used(); 
+            s.reserved = MEM_SIZE; 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        void *mem_alloc(const size_t size) {
+            if(size > MEM_SIZE - sizeof(Block)) 
+                return nullptr; 
+
+            const size_t c = class_of(size + sizeof(Block)); 
+            Block *bl = pop_class(c); 
+
+            if(!bl) {
+                if(!(bl = create_block(class_size(c)))) 
+                    return nullptr; 
+
+                bl->size = class_size(c) - sizeof(Block); 
+            }
+
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        // false for null or foreign ptrs
+        bool mem_free(void *ptr) {
+            if(!ptr || !owns(ptr)) 
+                return false; 
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            push(heads[class_of(bl->size + sizeof(Block))][shard], bl); 
+
+            return true; 
+        }
+
+        // payload bytes behind ptr, the whole class size. 0 for null or foreign ptrs
+        size_t mem_usable_size(const void *ptr) const {
+            return (ptr && owns(ptr) ? ((const Block*)((const char*)ptr - sizeof(Block)))->size : 0); 
+        }
+}; 
+
+
+// two level segregated fit: every free block sits in exactly one list picked from its size, 
+// two bitmaps tell which lists are non empty, so alloc and free never walk a list
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<TLSF, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class TwoLevel; 
+        #endif 
+
+        template<typename> friend class HeapWalk; 
+
+        struct Block {
+            size_t size;        // payload size, the low bits hold FREE and PREV_FREE
+            Block *prevPhys;    // block right in front of this one in memory
+        };
+
+        // only free blocks have these, stored in their payload
+        struct FreeLinks {
+            Block *prev, *next; 
+        };
+
+        static constexpr    size_t      MIN_BLOCK_SIZE          = sizeof(FreeLinks),
+                                        FREE                    = 1, 
+                                        PREV_FREE               = 2, 
+                                        FLAGS                   = FREE | PREV_FREE; 
+
+        static constexpr uint8_t floor_log2(const size_t x) { return 63 - __builtin_clzll(x); }
+
+        static constexpr    uint8_t     SL_LOG2                 = 4,                                // 16 second level lists per first level
+                                        SL_NUM                  = 1 << SL_LOG2, 
+                                        FL_SHIFT                = 8,                                // everything below 256b is first level 0, in 16b steps
+                                        FL_NUM                  = floor_log2(MEM_SIZE) - FL_SHIFT + 2; 
+
+        static constexpr    size_t      SMALL_BLOCK             = 1 << FL_SHIFT; 
+
+        static_assert(MEM_SIZE >= 4096, "MEM_SIZE too small for TLSF"); 
+        static_assert(std::is_same<HEADER, WideHeader>::value, "TLSF keeps its own header layout"); 
+        static_assert(ALIGNMENT >= 16 && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, level 0 works in 16b steps"); 
+
+        // first header sits so that its payload is aligned, every block (header + payload) is a multiple of ALIGNMENT
+        static constexpr    size_t      FIRST_BLOCK             = ((sizeof(Block) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+
+        Block *freeLists[FL_NUM][SL_NUM] { }; 
+        uint64_t flBitmap = 0;              // bit fl set -> slBitmap[fl] != 0
+        uint32_t slBitmap[FL_NUM] { };      // bit sl set -> freeLists[fl][sl] not empty 
+
+        Arena arena; 
+        void *memory; 
+        size_t offset = FIRST_BLOCK; 
+        Block *top = nullptr; // last block before offset, always in use
+
+        STATS counters; // see stats(), the classes are the first level lists
+
+        static_assert(FL_NUM <= MemStats::CLASS_NUM, "MEM_SIZE has more first level lists than MemStats has classes"); 
+
+        static inline size_t block_size(const Block *bl) { return bl->size & ~FLAGS; }
+        static inline FreeLinks *links(Block *bl) { return (FreeLinks*)((char*)bl + sizeof(Block)); }
+        static inline Block *next_phys(Block *bl) { return (Block*)((char*)bl + sizeof(Block) + block_size(bl)); }
+
+        inline bool in_use_range(const Block *bl) const { return (char*)bl < (char*)memory + offset; }
+
+        // list a block of exactly this size belongs to
+        static inline void mapping(const size_t size, uint8_t &fl, uint8_t &sl) {
+            if(size < SMALL_BLOCK) {
+                fl = 0; 
+                sl = size / (SMALL_BLOCK / SL_NUM); 
+                return; 
+            }
+
+            const uint8_t log = floor_log2(size); 
+            sl = (size >> (log - SL_LOG2)) ^ SL_NUM; 
+            fl = log - FL_SHIFT + 1; 
+        }
+
+        // first list whose blocks are all big enough for size
+        static inline void mapping_search(size_t size, uint8_t &fl, uint8_t &sl) {
+            if(size >= SMALL_BLOCK) 
+                size += ((size_t)1 << (floor_log2(size) - SL_LOG2)) - 1; 
+
+            mapping(size, fl, sl); 
+        }
+
+        inline Block *find_suitable(uint8_t &fl, uint8_t &sl) const {
+            if(fl >= FL_NUM) 
+                return nullptr; 
+
+            uint32_t slMap = slBitmap[fl] & (~0u << sl); 
+            if(!slMap) {
+                const uint64_t flMap = (fl + 1 < 64 ? flBitmap & (~0ull << (fl + 1)) : 0); 
+                if(!flMap) 
+                    return nullptr; 
+
+                fl = __builtin_ctzll(flMap); 
+                slMap = slBitmap[fl]; 
+            }
+
+            sl = __builtin_ctz(slMap); 
+            return freeLists[fl][sl]; 
+        }
+
+        void insert_block(Block *bl) {
+            uint8_t fl, sl; 
+            mapping(block_size(bl), fl, sl); 
+
+            Block *head = freeLists[fl][sl]; 
+            links(bl)->prev = nullptr; 
+            links(bl)->next = head; 
+
+            if(head) 
+                links(head)->prev = bl; 
+
+            freeLists[fl][sl] = bl; 
+            flBitmap |= 1ull << fl; 
+            slBitmap[fl] |= 1u << sl; 
+
+            counters.listed(fl, block_size(bl)); 
+        }
+
+        void remove_block(Block *bl, const uint8_t fl, const uint8_t sl) {
+            Block *prev = links(bl)->prev, 
+                  *next = links(bl)->next; 
+
+            counters.unlisted(fl, block_size(bl)); 
+
+            if(next) 
+                links(next)->prev = prev; 
+
+            if(prev) {
+                links(prev)->next = next; 
+                return; 
+            }
+
+            freeLists[fl][sl] = next; 
+            if(!next) {
+                slBitmap[fl] &= ~(1u << sl); 
+                if(!slBitmap[fl]) 
+                    flBitmap &= ~(1ull << fl); 
+            }
+        }
+
+        static inline uint8_t class_of(const size_t size) {
+            uint8_t fl, sl; 
+            mapping(size, fl, sl); 
+            return fl; 
+        }
+
+        inline void remove_block(Block *bl) {
+            uint8_t fl, sl; 
+            mapping(block_size(bl), fl, sl); 
+            remove_block(bl, fl, sl); 
+        }
+
+        Block *create_block(const size_t size) {
+            // enough space to create new Block?
+            if(size + sizeof(Block) > MEM_SIZE - offset || !arena.commit(offset + sizeof(Block) + size)) 
+                return nullptr; 
+
+            Block *bl = (Block*)((char*)memory + offset); 
+            bl->size = size; // top is never free, so no PREV_FREE
+            bl->prevPhys = top; 
+
+            top = bl; 
+            offset += sizeof(Block) + size; 
+
+            counters.offset(offset); 
+
+            return bl; 
+        }
+
+        // cut the tail off a free block that is bigger than needed and give it back
+        void split(Block *bl, const size_t size) {
+            const size_t rest = block_size(bl) - size; 
+            if(rest < sizeof(Block) + MIN_BLOCK_SIZE) 
+                return; 
+
+            Block *nbl = (Block*)((char*)bl + sizeof(Block) + size); 
+            nbl->size = (rest - sizeof(Block)) | FREE; 
+            nbl->prevPhys = bl; 
+            bl->size = size | (bl->size & FLAGS); 
+
+            // free blocks are never the top, so there is always a block behind nbl 
+            next_phys(nbl)->prevPhys = nbl; 
+            insert_block(nbl); 
+
+
+            counters.split(); 
+        }
+
+        // header at pos as a heap walk sees it, next is where the block behind it starts
+        inline HeapBlock block_at(const size_t pos, size_t &next) const {
+            const Block *bl = (const Block*)((char*)memory + pos); 
+            next = pos + sizeof(Block) + block_size(bl); 
+
+            return { (const char*)bl + sizeof(Block), block_size(bl), (bl->size & FREE) != 0 }; 
+        }
+
+    public: 
+
+        MemAllocator(const MemOptions &opts = MemOptions()) : arena(MEM_SIZE, opts), memory(arena.base()) {}
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out so far, free blocks below offset included
+        inline size_t mem_used() const { return offset; }
+
+        // counters and per class totals, only used, reserved and the page options without TrackStats
+        MemStats stats() const {
+            MemStats s; 
+            counters.snapshot(s); 
+            s.used = offset; 
+            s.reserved = MEM_SIZE; 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        // every block from the first to offset, see HeapWalk
+        inline HeapWalk<MemAllocator> walk() const { return HeapWalk<MemAllocator>(*this); }
+
+        // walks the whole heap, O(blocks)
+        MemReport report() const {
+            MemReport r(offset, MEM_SIZE, FL_NUM, sizeof(Block)); 
+            for(const HeapBlock &bl : walk()) 
+                r.add(bl, class_of(bl.size)); 
+
+            r.finish(); 
+            return r; 
+        }
+
+        void *mem_alloc(size_t size) {
+            if(size > MEM_SIZE) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            size = ((sizeof(Block) + (size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+
+            uint8_t fl, sl; 
+            mapping_search(size, fl, sl); 
+
+            Block *bl = find_suitable(fl, sl); 
+            if(bl) {
+                remove_block(bl, fl, sl); 
+                split(bl, size); 
+
+                // bl is in use now, let its neighbour know
+                bl->size &= ~FREE; 
+                next_phys(bl)->size &= ~PREV_FREE; 
+            }
+            else if(!(bl = create_block(size))) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            counters.alloc(class_of(block_size(bl)), block_size(bl)); 
+
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        // payload bytes behind ptr, can be more than asked for. 0 for null or foreign ptrs
+        size_t mem_usable_size(const void *ptr) const {
+            if(!ptr || ptr < memory || ptr >= (char*)memory + offset) 
+                return 0; 
+
+            return block_size((const Block*)((const char*)ptr - sizeof(Block))); 
+        }
+
+        bool mem_free(void *ptr) {
+            // check for null or foreign ptr
+            if(!ptr || ptr < memory || ptr >= (char*)memory + offset) 
+                return false; 
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            counters.free(class_of(block_size(bl)), block_size(bl)); 
+            bl->size |= FREE; 
+
+            // merge with the block in front
+            if(bl->size & PREV_FREE) {
+                Block *prev = bl->prevPhys; 
+                remove_block(prev); 
+                prev->size += sizeof(Block) + block_size(bl); 
+                bl = prev; 
+                counters.coalesce(); 
+            }
+
+            // merge with the block behind
+            Block *next = next_phys(bl); 
+            if(in_use_range(next) && (next->size & FREE)) {
+                remove_block(next); 
+                bl->size += sizeof(Block) + block_size(next); 
+                next = next_phys(bl); 
+                counters.coalesce(); 
+            }
+
+            // bl is the top now, hand it back to the bump region
+            if(!in_use_range(next)) {
+                top = bl->prevPhys; 
+                offset = (char*)bl - (char*)memory; 
+            }
+            else {
+                next->prevPhys = bl; 
+                next->size |= PREV_FREE; 
+                insert_block(bl); 
+            }
+
+
+            return true; 
+        }
+}; 
+
+
+
+// page sized slabs, every slab holds objects of one size class only and no object has a header. 
+// the slab an object belongs to is found by rounding its address down to the page. 
+// anything too big for a slab gets its own run of pages with the slab header in front.
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<SLAB, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class Slabs; 
+        #endif 
+
+        struct Slab {
+            Slab        *prev, *next;       // partial slabs of the same class 
+            uint32_t    pages;              // > 1 only for large runs 
+            uint16_t    objSize, 
+                        capacity, 
+                        used, 
+                        bumpIdx,            // slots from here on were never handed out
+                        freeIdx;            // first free slot, free slots link to the next by index
+            uint8_t     sizeClass; 
+        };
+
+        // free page runs, kept in the first page of the run
+        struct Run {
+            Run *next; 
+            size_t pages; 
+        };
+
+        static constexpr    size_t      SLAB_SIZE               = 4096, 
+                                        SLAB_HEADER             = 32,
+                                        MAX_SLAB_OBJ            = 1024; 
+
+        // objects are aligned to the biggest power of two dividing their class size, at most 16
+        static_assert(ALIGNMENT <= 16, "SLAB objects can't be aligned past 16b"); 
+        static_assert(std::is_same<HEADER, WideHeader>::value, "SLAB objects have no header"); 
+
+        static constexpr    uint16_t    NO_SLOT                 = UINT16_MAX; 
+
+        static constexpr    uint8_t     SIZE_CLASS_NUM          = 13, 
+                                        LARGE                   = SIZE_CLASS_NUM; 
+
+        static constexpr    uint16_t    CLASS_SIZES[SIZE_CLASS_NUM] = { 4, 8, 16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 1024 }; 
+
+        static_assert(sizeof(Slab) <= SLAB_HEADER, "slab header grew, fix SLAB_HEADER"); 
+
+        // size -> class for everything a slab can hold, in 4b steps
+        struct ClassTable {
+            uint8_t of[MAX_SLAB_OBJ / 4 + 1] { }; 
+
+            constexpr ClassTable() {
+                uint8_t c = 0; 
+                for(size_t i = 0; i <= MAX_SLAB_OBJ / 4; i++) {
+                    while(CLASS_SIZES[c] < i * 4) 
+                        c++; 
+
+                    of[i] = c; 
+                }
+            }
+        }; 
+
+        static constexpr    ClassTable  classTable              { }; 
+
+        Slab *partial[SIZE_CLASS_NUM] { nullptr };  // slabs with at least one free slot
+        Run *freeRuns = nullptr; 
+        Arena arena; 
+        void *memory; 
+        size_t offset = 0; 
+
+        // see stats(), the classes are the size classes plus LARGE. free blocks are the free page runs, 
+        // they all count as LARGE. free slots inside a slab arent blocks and dont show up
+        STATS counters; 
+
+        static inline Slab *slab_of(const void *ptr) { return (Slab*)((uintptr_t)ptr & ~(SLAB_SIZE - 1)); }
+        static inline char *slot(Slab *sl, const uint16_t idx) { return (char*)sl + SLAB_HEADER + (size_t)idx * sl->objSize; }
+
+        // first fitting free run, otherwise fresh pages from the bump region
+        void *get_pages(const size_t pages) {
+            for(Run **r = &freeRuns; *r; r = &(*r)->next) {
+                Run *run = *r; 
+                if(run->pages < pages) 
+                    continue; 
+
+                counters.unlisted(LARGE, run->pages * SLAB_SIZE); 
+
+                // use the front, the rest stays a run
+                if(run->pages > pages) {
+                    Run *rest = (Run*)((char*)run + pages * SLAB_SIZE); 
+                    rest->pages = run->pages - pages; 
+                    rest->next = run->next; 
+                    *r = rest; 
+
+                    counters.listed(LARGE, rest->pages * SLAB_SIZE); 
+                    counters.split(); 
+                }
+                else 
+                    *r = run->next; 
+
+                return run; 
+            }
+
+            const size_t size = pages * SLAB_SIZE; 
+            if(size > MEM_SIZE - offset || !arena.commit(offset + size)) 
+                return nullptr; 
+
+            void *mem = (char*)memory + offset; 
+            offset += size; 
+            counters.offset(offset); 
+
+            return mem; 
+        }
+
+        // runs are sorted by address, so neighbours get merged and pages dont crumble into single ones
+        void release_pages(void *mem, size_t pages) {
+            Run **link = &freeRuns,         // where the run gets linked in
+                **prevLink = nullptr;       // link to the run in front
+
+            while(*link && *link < mem) {
+                prevLink = link; 
+                link = &(*link)->next; 
+            }
+
+            Run *next = *link; 
+
+            // merge with the run behind
+            if(next && (char*)mem + pages * SLAB_SIZE == (char*)next) {
+                counters.unlisted(LARGE, next->pages * SLAB_SIZE); 
+                counters.coalesce(); 
+
+                pages += next->pages; 
+                next = next->next; 
+            }
+
+            // merge with the run in front
+            if(prevLink && (char*)*prevLink + (*prevLink)->pages * SLAB_SIZE == (char*)mem) {
+                counters.unlisted(LARGE, (*prevLink)->pages * SLAB_SIZE); 
+                counters.coalesce(); 
+
+                mem = *prevLink; 
+                pages += (*prevLink)->pages; 
+                link = prevLink; 
+            }
+
+            // top of the bump region, just give it back
+            if((char*)mem + pages * SLAB_SIZE == (char*)memory + offset) {
+                offset -= pages * SLAB_SIZE; 
+                *link = next; 
+                return; 
+            }
+
+            Run *run = (Run*)mem; 
+            run->pages = pages; 
+            run->next = next; 
+            *link = run; 
+
+            counters.listed(LARGE, pages * SLAB_SIZE); 
+        }
+
+        inline void push_partial(Slab *sl) {
+            sl->prev = nullptr; 
+            sl->next = partial[sl->sizeClass]; 
+
+            if(sl->next) 
+                sl->next->prev = sl; 
+
+            partial[sl->sizeClass] = sl; 
+        }
+
+        inline void remove_partial(Slab *sl) {
+            if(sl->prev) 
+                sl->prev->next = sl->next; 
+            else 
+                partial[sl->sizeClass] = sl->next; 
+
+            if(sl->next) 
+                sl->next->prev = sl->prev; 
+        }
+
+        Slab *create_slab(const uint8_t sizeClass) {
+            Slab *sl = (Slab*)get_pages(1); 
+            if(!sl) 
+                return nullptr; 
+
+            sl->pages = 1; 
+            sl->objSize = CLASS_SIZES[sizeClass]; 
+            sl->capacity = (SLAB_SIZE - SLAB_HEADER) / sl->objSize; 
+            sl->used = 0; 
+            sl->bumpIdx = 0; 
+            sl->freeIdx = NO_SLOT; 
+            sl->sizeClass = sizeClass; 
+
+            push_partial(sl); 
+
+            return sl; 
+        }
+
+        void *alloc_small(const uint8_t sizeClass) {
+            Slab *sl = partial[sizeClass]; 
+            if(!sl && !(sl = create_slab(sizeClass))) 
+                return nullptr; 
+
+            uint16_t idx; 
+            if(sl->freeIdx != NO_SLOT) {
+                idx = sl->freeIdx; 
+                sl->freeIdx = *(uint16_t*)slot(sl, idx); 
+            }
+            else 
+                idx = sl->bumpIdx++; 
+
+            // full slabs leave the partial list until something gets freed
+            if(++sl->used == sl->capacity) 
+                remove_partial(sl); 
+
+            return slot(sl, idx); 
+        }
+
+        void *alloc_large(const size_t size) {
+            const size_t pages = (SLAB_HEADER + size + SLAB_SIZE - 1) / SLAB_SIZE; 
+
+            Slab *sl = (Slab*)get_pages(pages); 
+            if(!sl) 
+                return nullptr; 
+
+            sl->pages = pages; 
+            sl->sizeClass = LARGE; 
+
+            return (char*)sl + SLAB_HEADER; 
+        }
+
+        void free_small(Slab *sl, void *ptr) {
+            const uint16_t idx = ((char*)ptr - (char*)sl - SLAB_HEADER) / sl->objSize; 
+
+            if(sl->used-- == sl->capacity) 
+                push_partial(sl); 
+
+            // empty slabs go back to the pages, unless its the last one of its class
+            if(sl->used == 0 && (sl->prev || sl->next)) {
+                remove_partial(sl); 
+                release_pages(sl, 1); 
+                return; 
+            }
+
+            *(uint16_t*)ptr = sl->freeIdx; 
+            sl->freeIdx = idx; 
+        }
+
+    public: 
+
+        MemAllocator(const MemOptions &opts = MemOptions()) : arena(MEM_SIZE, opts), memory(arena.base()) {}
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out so far, free blocks below offset included
+        inline size_t mem_used() const { return offset; }
+
+        // counters and per class totals, only used, reserved and the page options without TrackStats
+        MemStats stats() const {
+            MemStats s; 
+            counters.snapshot(s); 
+            s.used = offset; 
+            s.reserved = MEM_SIZE; 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        void *mem_alloc(const size_t size) {
+            void *ptr = (size <= MAX_SLAB_OBJ ? alloc_small(classTable.of[(size + 3) / 4]) : alloc_large(size)); 
+
+            if constexpr(STATS::ENABLED) {
+                if(ptr) 
+                    counters.alloc(slab_of(ptr)->sizeClass, mem_usable_size(ptr)); 
+                else 
+                    counters.failed(); 
+            }
+
+            return ptr; 
+        }
+
+        // payload bytes behind ptr, the whole class size or the rest of a large run. 0 for null or foreign ptrs
+        size_t mem_usable_size(const void *ptr) const {
+            if(!ptr || ptr < memory || ptr >= (char*)memory + offset) 
+                return 0; 
+
+            const Slab *sl = slab_of(ptr); 
+            return (sl->sizeClass == LARGE ? sl->pages * SLAB_SIZE - SLAB_HEADER : sl->objSize); 
+        }
+
+        bool mem_free(void *ptr) {
+            // check for null or foreign ptr
+            if(!ptr || ptr < memory || ptr >= (char*)memory + offset) 
+                return false; 
+
+            Slab *sl = slab_of(ptr); 
+            counters.free(sl->sizeClass, mem_usable_size(ptr)); 
+
+            if(sl->sizeClass == LARGE) 
+                release_pages(sl, sl->pages); 
+            else 
+                free_small(sl, ptr); 
+
+            return true; 
+        }
+}; 
+
+// a monotonic arena, mem_alloc only moves offset up and blocks have no header. 
+// blocks arent freed one by one, rewind() drops everything since a mark() and reset() the whole arena, both in O(1). 
+// mem_free only takes back the latest block, for everything else it does nothing
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<BUMP, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class BumpArenas; 
+        #endif 
+
+        static_assert(ALIGNMENT <= 4096 && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, at most a page"); 
+        static_assert(std::is_same<HEADER, WideHeader>::value, "BUMP blocks have no header"); 
+
+        Arena arena; 
+        void *memory; 
+        size_t offset = 0, 
+               last = 0,    // start of the latest block, the only one mem_free can take back
+               peak = 0;    // highest offset since reset() last released pages
+
+        STATS counters; // see stats(), only failed allocs and the high water mark, there are no classes
+
+        inline void *bump(const size_t start, const size_t size) {
+            if(!arena.commit(start + size)) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            last = start; 
+            offset = start + size; 
+            counters.offset(offset); 
+
+            return (char*)memory + start; 
+        }
+
+        // rounded up to ALIGNMENT, so the next block is aligned too. size 0 gets ALIGNMENT bytes, 
+        // otherwise it would share its address with the next block and a mem_free of it would take that one back
+        static inline size_t block_bytes(const size_t size) {
+            return (size ? (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1) : ALIGNMENT); 
+        }
+
+        inline void note_peak() {
+            if(offset > peak) 
+                peak = offset; 
+        }
+
+    public: 
+
+        // where the arena stood at mark(), rewind() goes back to it
+        struct Marker {
+            size_t offset; 
+        }; 
+
+        MemAllocator(const MemOptions &opts = MemOptions()) : arena(MEM_SIZE, opts), memory(arena.base()) {}
+
+        // how the heap ended up backed, may be less than MemOptions asked for
+        inline Pages page_mode() const { return arena.pages(); }
+        inline bool prefaulted() const { return arena.prefaulted(); }
+
+        // bytes of the arena handed out since the last reset
+        inline size_t mem_used() const { return offset; }
+
+        inline bool owns(const void *ptr) const { return ptr >= memory && ptr < (char*)memory + offset; }
+
+        MemStats stats() const {
+            MemStats s; 
+            counters.snapshot(s); 
+            s.used = offset; 
+            s.reserved = MEM_SIZE; 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        // sizes are rounded up to ALIGNMENT, see block_bytes
+        void *mem_alloc(const size_t size) {
+            const size_t bytes = block_bytes(size); 
+
+            if(size > MEM_SIZE || bytes > MEM_SIZE - offset) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            return bump(offset, bytes); 
+        }
+
+        // alignment has to be a power of two, the gap in front of the block is lost until the next rewind or reset
+        void *mem_alloc_aligned(const size_t size, const size_t alignment) {
+            if(alignment <= ALIGNMENT) 
+                return mem_alloc(size); 
+
+            const size_t start = (((uintptr_t)memory + offset + alignment - 1) & ~(alignment - 1)) - (uintptr_t)memory, 
+                         bytes = block_bytes(size); 
+
+            if((alignment & (alignment - 1)) || size > MEM_SIZE || start > MEM_SIZE || bytes > MEM_SIZE - start) {
+                counters.failed(); 
+                return nullptr; 
+            }
+
+            return bump(start, bytes); 
+        }
+
+        // false for null or foreign ptrs. the latest block goes back to the arena, any other block stays until rewind or reset
+        bool mem_free(void *ptr) {
+            if(!ptr || !owns(ptr)) 
+                return false; 
+
+            if(ptr == (char*)memory + last) {
+                note_peak(); 
+                offset = last; 
+            }
+
+            return true; 
+        }
+
+        inline Marker mark() const { return { offset }; }
+
+        // drops every block allocated since m, markers nest like scopes. 
+        // false if the arena already went back past m (a rewind to an older marker or a reset)
+        bool rewind(const Marker m) {
+            if(m.offset > offset) 
+                return false; 
+
+            note_peak(); 
+            offset = last = m.offset; 
+
+            return true; 
+        }
+
+        // drops every block. if the arena reached past keep since the last release, 
+        // the pages behind keep go back to the kernel (MADV_DONTNEED), so one big request doesnt pin its memory for good
+        void reset(const size_t keep = SIZE_MAX) {
+            note_peak(); 
+            offset = last = 0; 
+
+            if(peak > keep) {
+                arena.release(keep, peak); 
+                peak = keep; 
+            }
+        }
+};
+
+
+// one heap in a shared memory object that several processes map at once, e.g. MemAllocator<SHARED, 256*1024*1024> mem("/workers"); 
+// the first process to open the name creates and sets it up, every other one attaches to it. 
+// the mapping lands at a different address in every process, so blocks and free lists only ever refer to positions in the heap: 
+// a process hands another one offset_of(ptr) and that one finds the same bytes at at(offset), nothing gets copied. 
+// the heap works like PRECISE (boundary tags, coalescing on free, size classes by power of two) under one process-shared lock 
+// kept in the first page of the mapping, together with the top and the heads of the size classes
+template<const size_t MEM_SIZE, const size_t ALIGNMENT, typename STATS, typename HEADER>
+class MemAllocator<SHARED, MEM_SIZE, ALIGNMENT, STATS, HEADER> {
+
+    private: 
+        #ifdef DEBUG 
+            friend class SharedHeap; 
+        #endif 
+
+        // offset is where the next block starts, its low bits hold FREE and PREV_FREE like PRECISE
+        struct Block {
+            size_t size, offset; 
+        };
+
+        // positions of the neighbours in the size class, NONE ends the list
+        struct FreeLinks {
+            size_t prev, next; 
+        };
+
+        // boundary tag, the last word of a free blocks payload holds where the block starts
+        using Tag = size_t; 
+
+        static constexpr uint8_t floor_log2(const size_t x) { return 63 - __builtin_clzll(x); }
+
+        static constexpr    size_t      FREE                    = 1, 
+                                        PREV_FREE               = 2, 
+                                        FLAGS                   = FREE | PREV_FREE, 
+                                        NONE                    = SIZE_MAX, 
+                                        CLASS_NUM               = 64,           // class c holds the free blocks from 2^c up to 2^(c+1) - 1 bytes
+                                        MIN_BLOCK_SIZE          = sizeof(FreeLinks) + sizeof(Tag), 
+                                        HEADER_PAGE             = 4096, 
+                                        MAPPING                 = HEADER_PAGE + ((MEM_SIZE + HEADER_PAGE - 1) & ~(HEADER_PAGE - 1)); 
+
+        static constexpr    uint64_t    MAGIC                   = 0x4d656d5368617265;   // "MemShare"
+
+        // first header sits so that its payload is aligned, every block (header + payload) is a multiple of ALIGNMENT
+        static constexpr    size_t      FIRST_BLOCK             = ((sizeof(Block) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+
+        static_assert(ALIGNMENT >= 8 && ALIGNMENT <= HEADER_PAGE && !(ALIGNMENT & (ALIGNMENT - 1)), "ALIGNMENT has to be a power of two, from 8 up to a page"); 
+        static_assert(!STATS::ENABLED, "TrackStats counts in the memory of one process, the heap is changed by all of them"); 
+        static_assert(std::is_same<HEADER, WideHeader>::value, "SHARED keeps its own header layout"); 
+
+        // a pthread mutex every process can take. its robust, if a process dies holding it the next one to lock it takes over. 
+        // the heap may be half changed then, robustness only keeps the others from hanging
+        struct Lock {
+            pthread_mutex_t m; 
+
+            void init() {
+                pthread_mutexattr_t attr; 
+                pthread_mutexattr_init(&attr); 
+                pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED); 
+                pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST); 
+                pthread_mutex_init(&m, &attr); 
+                pthread_mutexattr_destroy(&attr); 
+            }
+
+            inline void lock() {
+                if(pthread_mutex_lock(&m) == EOWNERDEAD) 
+                    pthread_mutex_consistent(&m); 
+            }
+
+            inline void unlock() { pthread_mutex_unlock(&m); }
+        }; 
+
+        // the first page of the mapping, everything of the heap thats not in the blocks
+        struct Header {
+            uint64_t magic, memSize, alignment;     // an attaching process checks it was built the same way
+            std::atomic<uint32_t> ready;            // set up, the creator flips it last
+            Lock lock; 
+            size_t offset;                          // where the bump region starts
+            uint64_t nonEmpty;                      // bit per size class with free blocks
+            size_t heads[CLASS_NUM]; 
+        }; 
+
+        static_assert(sizeof(Header) <= HEADER_PAGE, "the header has to fit its page"); 
+
+        bool creator;       // this process set the heap up
+        int file; 
+        Arena arena; 
+        Header *header; 
+        void *memory;       // right behind the header page
+
+        // the shared memory object, a new one gets its full size right away so the others can map it
+        static int open_name(const char *name, bool &created) {
+            int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600); 
+            created = (fd >= 0); 
+
+            if(created && ftruncate(fd, MAPPING)) {
+                perror("ftruncate"); 
+                exit(1); 
+            }
+
+            if(!created && errno == EEXIST) 
+                fd = shm_open(name, O_RDWR, 0600); 
+
+            if(fd < 0) {
+                perror("shm_open"); 
+                exit(1); 
+            }
+
+            // the creator may not have sized it yet
+            struct stat st; 
+            for(int i = 0; !fstat(fd, &st) && (size_t)st.st_size < MAPPING; i++) {
+                if(i == 1000) {
+                    fprintf(stderr, "shared heap %s is smaller than MEM_SIZE, if its creator died remove it with unlink(name)\n", name); 
+                    exit(1); 
+                }
+
+                usleep(1000); 
+            }
+
+            return fd; 
+        }
+
+        // an empty file becomes a new heap, anything else has to be one already
+        static int open_fd(const int fd, bool &created) {
+            struct stat st; 
+            if(fstat(fd, &st)) {
+                perror("fstat"); 
+                exit(1); 
+            }
+
+            created = !st.st_size; 
+            if(created && ftruncate(fd, MAPPING)) {
+                perror("ftruncate"); 
+                exit(1); 
+            }
+
+            return dup(fd); 
+        }
+
+        // name only shows up in the error, nullptr for a heap opened from an fd
+        void attach(const char *name) {
+            if(creator) {
+                header->magic = MAGIC; 
+                header->memSize = MEM_SIZE; 
+                header->alignment = ALIGNMENT; 
+                header->lock.init(); 
+                header->offset = FIRST_BLOCK; 
+                header->nonEmpty = 0; 
+
+                for(size_t &h : header->heads) 
+                    h = NONE; 
+
+                header->ready.store(1, std::memory_order_release); 
+                return; 
+            }
+
+            // the creator may still be setting it up, or it died before it was done. gives up after about 1s like open_name
+            for(int i = 0; !header->ready.load(std::memory_order_acquire); i++) {
+                if(i == 10000) {
+                    fprintf(stderr, "shared heap %s never got ready, if its creator died remove it with unlink(name)\n", (name ? name : "(fd)")); 
+                    exit(1); 
+                }
+
+                usleep(100); 
+            }
+
+            if(header->magic != MAGIC || header->memSize != MEM_SIZE || header->alignment != ALIGNMENT) {
+                fprintf(stderr, "shared heap was set up with another MEM_SIZE or ALIGNMENT\n"); 
+                exit(1); 
+            }
+        }
+
+        inline Block *block_at(const size_t pos) const { return (Block*)((char*)memory + pos); }
+        inline size_t pos_of(const Block *bl) const { return (char*)bl - (char*)memory; }
+        static inline FreeLinks *links(Block *bl) { return (FreeLinks*)((char*)bl + sizeof(Block)); }
+
+        static inline size_t next_pos(const Block *bl) { return bl->offset & ~FLAGS; }
+        inline Block *next_block(const Block *bl) const { return block_at(next_pos(bl)); }
+
+        // moves the end of bl, its flags stay
+        static inline void set_next(Block *bl, const size_t pos) { bl->offset = pos | (bl->offset & FLAGS); }
+
+        // payload has to hold the free links and tag, and keep the next payload aligned
+        static inline size_t adjust_size(const size_t size) {
+            return ((sizeof(Block) + (size < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : size) + ALIGNMENT - 1) & ~(ALIGNMENT - 1)) - sizeof(Block); 
+        }
+
+        void remove_block_from_class(Block *bl) {
+            const uint8_t c = floor_log2(bl->size); 
+            const FreeLinks *l = links(bl); 
+
+            if(l->prev != NONE) 
+                links(block_at(l->prev))->next = l->next; 
+            else if((header->heads[c] = l->next) == NONE) 
+                header->nonEmpty &= ~((uint64_t)1 << c); 
+
+            if(l->next != NONE) 
+                links(block_at(l->next))->prev = l->prev; 
+
+            // free blocks are never the top, there is always a block behind bl
+            next_block(bl)->offset &= ~PREV_FREE; 
+        }
+
+        void add_block_to_class(Block *bl) {
+            const uint8_t c = floor_log2(bl->size); 
+            const size_t pos = pos_of(bl), 
+                         head = header->heads[c]; 
+
+            links(bl)->prev = NONE; 
+            links(bl)->next = head; 
+
+            if(head != NONE) 
+                links(block_at(head))->prev = pos; 
+
+            header->heads[c] = pos; 
+            header->nonEmpty |= (uint64_t)1 << c; 
+
+            // leave the tag for the block behind, so it can find bl when it gets freed
+            *(Tag*)((char*)next_block(bl) - sizeof(Tag)) = pos; 
+            next_block(bl)->offset |= PREV_FREE; 
+        }
+
+        Block *create_block(const size_t size) {
+            const size_t pos = header->offset; 
+
+            if(size + sizeof(Block) > MEM_SIZE - pos) 
+                return nullptr; 
+
+            Block *bl = block_at(pos); 
+            bl->size = size; 
+            bl->offset = pos + sizeof(Block) + size; // no flags, the top is never free and never behind a free block
+
+            header->offset = bl->offset; 
+            return bl; 
+        }
+
+        // whatever bl (taken out of its class) has past size goes back as a free block
+        void cut_tail(Block *bl, const size_t size) {
+            if(bl->size < size + sizeof(Block) + MIN_BLOCK_SIZE) 
+                return; 
+
+            Block *tbl = (Block*)((char*)bl + sizeof(Block) + size); 
+            tbl->size = bl->size - size - sizeof(Block); 
+            tbl->offset = next_pos(bl) | FREE; 
+
+            bl->size = size; 
+            set_next(bl, pos_of(tbl)); 
+            add_block_to_class(tbl); 
+        }
+
+        // first fit in the own class, where blocks may still be too small, otherwise the head of the next class up. 
+        // every block there fits, the bitmap finds it in one step
+        Block *find_block(const size_t size) {
+            const uint8_t c = floor_log2(size); 
+
+            for(size_t pos = header->heads[c]; pos != NONE; pos = links(block_at(pos))->next) {
+                Block *bl = block_at(pos); 
+
+                if(bl->size >= size) {
+                    remove_block_from_class(bl); 
+                    cut_tail(bl, size); 
+                    return bl; 
+                }
+            }
+
+            const uint64_t above = ((size_t)c + 1 < CLASS_NUM ? header->nonEmpty & (~(uint64_t)0 << (c + 1)) : 0); 
+            if(!above) 
+                return nullptr; 
+
+            Block *bl = block_at(header->heads[__builtin_ctzll(above)]); 
+            remove_block_from_class(bl); 
+            cut_tail(bl, size); 
+
+            return bl; 
+        }
+
+        // merges bl with free neighbours on both sides, returns the merged block
+        Block *coalescing(Block *bl) {
+            Block *nbl = next_block(bl); 
+            if(next_pos(bl) != header->offset && (nbl->offset & FREE)) {
+                remove_block_from_class(nbl); 
+
+                set_next(bl, next_pos(nbl)); 
+                bl->size += sizeof(Block) + nbl->size; 
+            }
+
+            if(bl->offset & PREV_FREE) {
+                Block *pbl = block_at(*((Tag*)bl - 1)); 
+                remove_block_from_class(pbl); 
+
+                set_next(pbl, next_pos(bl)); 
+                pbl->size += sizeof(Block) + bl->size; 
+                bl = pbl; 
+            }
+
+            return bl; 
+        }
+
+        inline bool in_heap(const void *ptr) const {
+            return ptr >= (char*)memory + FIRST_BLOCK + sizeof(Block) && ptr < (char*)memory + header->offset; 
+        }
+
+    public: 
+
+        // name is a shared memory object name like "/workers", it stays around until unlink(name), 
+        // so a process that starts later attaches to the same heap. only MemOptions::prefault is used
+        MemAllocator(const char *name, const MemOptions &opts = MemOptions()) 
+            : file(open_name(name, creator)), arena(file, MAPPING, opts), header((Header*)arena.base()), 
+              memory((char*)arena.base() + HEADER_PAGE) { attach(name); }
+
+        // the heap in fd, e.g. a memfd_create one passed on through fork or a unix socket. an empty file gets set up as a new heap, 
+        // so it should be passed on only after the first process opened it. fd stays open, the heap works on its own copy
+        MemAllocator(const int fd, const MemOptions &opts = MemOptions()) 
+            : file(open_fd(fd, creator)), arena(file, MAPPING, opts), header((Header*)arena.base()), 
+              memory((char*)arena.base() + HEADER_PAGE) { attach(nullptr); }
+
+        // unmaps the heap in this process, its blocks stay for the others
+        ~MemAllocator() { close(file); }
+
+        MemAllocator(const MemAllocator&) = delete; 
+        MemAllocator &operator=(const MemAllocator&) = delete; 
+
+        // removes the name, the memory goes once the last process unmapped it
+        static bool unlink(const char *name) { return !shm_unlink(name); }
+
+        inline int fd() const { return file; }
+        inline bool created() const { return creator; }
+
+        // the same payload in every process that has the heap mapped
+        inline size_t offset_of(const void *ptr) const { return (const char*)ptr - (const char*)memory; }
+        inline void *at(const size_t offset) const { return (char*)memory + offset; }
+
+        inline size_t mem_used() {
+            std::lock_guard<Lock> l(header->lock); 
+            return header->offset; 
+        }
+
+        // only used, reserved, resident and the page options, counters would need one writer
+        MemStats stats() {
+            MemStats s; 
+            s.used = mem_used(); 
+            s.reserved = MEM_SIZE; 
+            s.resident = arena.resident(); 
+            s.pages = arena.pages(); 
+            s.prefaulted = arena.prefaulted(); 
+
+            return s; 
+        }
+
+        inline bool owns(const void *ptr) {
+            std::lock_guard<Lock> l(header->lock); 
+            return in_heap(ptr); 
+        }
+
+        void *mem_alloc(const size_t size) {
+            if(size > MEM_SIZE) 
+                return nullptr; 
+
+            const size_t bytes = adjust_size(size); 
+            std::lock_guard<Lock> l(header->lock); 
+
+            Block *bl = find_block(bytes); 
+            if(!bl && !(bl = create_block(bytes))) 
+                return nullptr; 
+
+            bl->offset &= ~FREE; 
+            return (char*)bl + sizeof(Block); // user memory
+        }
+
+        // any process can free any block, not only the one that allocated it
+        bool mem_free(const void *ptr) {
+            std::lock_guard<Lock> l(header->lock); 
+
+            if(!in_heap(ptr)) 
+                return false; 
+
+            Block *bl = (Block*)((char*)ptr - sizeof(Block)); 
+            bl->offset |= FREE; 
+            bl = coalescing(bl); 
+
+            // bl is the top now, hand it back to the bump region
+            if(next_pos(bl) == header->offset) 
+                header->offset = pos_of(bl); 
+            else 
+                add_block_to_class(bl); 
+
+            return true; 
+        }
+
+        // payload bytes behind ptr, can be more than asked for
+        size_t mem_usable_size(const void *ptr) const {
+            return (ptr ? ((const Block*)((const char*)ptr - sizeof(Block)))->size : 0); 
+        }
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "memAlloc.h"
+#include <new>
+#include <utility>
+#include <type_traits>
+
+
+// N objects of one type T in an arena of their own, e.g. MemPool<Connection, 100'000> pool;
+// slots are sized and aligned for T at compile time and carry no header. free slots form an intrusive stack,
+// so create() and destroy() are O(1) without any size lookup. slots past the highest one used so far
+// are never touched, their pages only get committed once the pool grows into them.
+template<typename T, const size_t N>
+class MemPool {
+
+    private:
+        #ifdef DEBUG
+            friend class Pools;
+        #endif
+
+        // a free slot holds the link to the next free one where the object would be
+        union Slot {
+            Slot *next;
+            alignas(T) unsigned char obj[sizeof(T)];
+        };
+
+        // clear() has to find the live objects to run their destructors, a bit per slot tells them apart.
+        // types without a destructor dont need it, clear() just forgets them
+        static constexpr    bool        TRACK_LIVE              = !std::is_trivially_destructible<T>::value;
+
+        static constexpr    size_t      WORD_BITS               = 64,
+                                        LIVE_BYTES              = (TRACK_LIVE ? (N + WORD_BITS - 1) / WORD_BITS * sizeof(uint64_t) : 0),
+                                        SLOTS_START             = (LIVE_BYTES + alignof(Slot) - 1) & ~(alignof(Slot) - 1);
+
+        static_assert(N > 0, "MemPool needs at least one slot");
+        static_assert(alignof(Slot) <= 4096, "MemPool slots can't be aligned past a page");
+
+        Arena arena;
+        uint64_t *liveBits;     // in front of the slots, empty without TRACK_LIVE
+        Slot *slots;
+        Slot *freeSlots = nullptr;
+        size_t bump = 0,        // slots from here on were never handed out
+               live = 0;
+
+        inline size_t index_of(const Slot *sl) const { return sl - slots; }
+
+        Slot *get_slot() {
+            if(freeSlots) {
+                Slot *sl = freeSlots;
+                freeSlots = sl->next;
+                return sl;
+            }
+
+            if(bump == N || !arena.commit(SLOTS_START + (bump + 1) * sizeof(Slot)))
+                return nullptr;
+
+            return &slots[bump++];
+        }
+
+        inline void put_slot(Slot *sl) {
+            sl->next = freeSlots;
+            freeSlots = sl;
+        }
+
+    public:
+
+        // throws std::bad_alloc if the kernel wont back the live bits, clear() couldnt even read them then
+        MemPool(const MemOptions &opts = MemOptions())
+            : arena(SLOTS_START + N * sizeof(Slot), opts), liveBits((uint64_t*)arena.base()),
+              slots((Slot*)((char*)arena.base() + SLOTS_START)) {
+            if constexpr(TRACK_LIVE)
+                if(!arena.commit(LIVE_BYTES))
+                    throw std::bad_alloc();
+        }
+
+        // objects still alive get destroyed with the pool
+        ~MemPool() { clear(); }
+
+        MemPool(const MemPool&) = delete;
+        MemPool &operator=(const MemPool&) = delete;
+
+        static constexpr size_t capacity() { return N; }
+        inline size_t size() const { return live; }
+
+        inline bool owns(const T *obj) const {
+            return (const void*)obj >= (const void*)slots && (const void*)obj < (const void*)(slots + bump);
+        }
+
+        // builds a T from args in a free slot, nullptr once all N slots are taken.
+        // if the constructor throws, the slot goes back and the exception goes on
+        template<typename... Args>
+        T *create(Args&&... args) {
+            Slot *sl = get_slot();
+            if(!sl)
+                return nullptr;
+
+            T *obj;
+            try {
+                obj = new(sl->obj) T(std::forward<Args>(args)...);
+            }
+            catch(...) {
+                put_slot(sl);
+                throw;
+            }
+
+            if constexpr(TRACK_LIVE) {
+                const size_t idx = index_of(sl);
+                liveBits[idx / WORD_BITS] |= (uint64_t)1 << (idx % WORD_BITS);
+            }
+
+            live++;
+            return obj;
+        }
+
+        // obj has to come from this pool, null is ignored
+        void destroy(T *obj) {
+            if(!obj)
+                return;
+
+            obj->~T();
+            Slot *sl = (Slot*)obj;
+
+            if constexpr(TRACK_LIVE) {
+                const size_t idx = index_of(sl);
+                liveBits[idx / WORD_BITS] &= ~((uint64_t)1 << (idx % WORD_BITS));
+            }
+
+            put_slot(sl);
+            live--;
+        }
+
+        // destroys every object at once and starts over with an empty pool.
+        // O(1) for types without a destructor, otherwise one pass over the live bits of the slots used so far
+        void clear() {
+            if constexpr(TRACK_LIVE) {
+                for(size_t w = 0; w < (bump + WORD_BITS - 1) / WORD_BITS; w++) {
+                    for(uint64_t bits = liveBits[w]; bits; bits &= bits - 1)
+                        ((T*)slots[w * WORD_BITS + __builtin_ctzll(bits)].obj)->~T();
+
+                    liveBits[w] = 0;
+                }
+            }
+
+            freeSlots = nullptr;
+            bump = live = 0;
+        }
+};
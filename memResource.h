@@ -0,0 +1,94 @@
+#pragma once
+
+#include "memAlloc.h"
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+
+// adapters so STL containers can live in a heap.
+// both only hold a reference, the heap has to outlive every container using it.
+// works with every preset that has mem_alloc_aligned (FAST, PRECISE, THREADED, BUMP as a monotonic resource).
+
+// std::pmr view on a heap, e.g. std::pmr::vector<int> v(&res);
+template<typename A>
+class MemResource : public std::pmr::memory_resource {
+
+    private:
+        A &mem;
+
+    protected:
+
+        // alignments up to the heaps ALIGNMENT are just mem_alloc inside mem_alloc_aligned
+        void *do_allocate(const size_t bytes, const size_t alignment) override {
+            void *ptr = mem.mem_alloc_aligned(bytes, alignment);
+            if(!ptr)
+                throw std::bad_alloc();
+
+            return ptr;
+        }
+
+        // blocks know their own size, so bytes and alignment arent needed
+        void do_deallocate(void *ptr, size_t, size_t) override {
+            mem.mem_free(ptr);
+        }
+
+        // memory from one resource can only be freed by a resource on the same heap
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            const MemResource *o = dynamic_cast<const MemResource*>(&other);
+            return o && &o->mem == &mem;
+        }
+
+    public:
+
+        MemResource(A &mem) : mem(mem) {}
+
+        inline A &heap() const { return mem; }
+};
+
+// stateful allocator for the normal STL containers, e.g. std::list<int, MemStlAllocator<int, MemAllocator<>>> l(mem);
+template<typename T, typename A>
+class MemStlAllocator {
+
+    private:
+        template<typename, typename> friend class MemStlAllocator;
+
+        A *mem;
+
+    public:
+        using value_type = T;
+
+        // containers moved or swapped take the heap with them
+        using propagate_on_container_copy_assignment    = std::true_type;
+        using propagate_on_container_move_assignment    = std::true_type;
+        using propagate_on_container_swap               = std::true_type;
+
+        MemStlAllocator(A &mem) noexcept : mem(&mem) {}
+
+        // rebind, e.g. a list turning MemStlAllocator<T> into one for its nodes
+        template<typename U>
+        MemStlAllocator(const MemStlAllocator<U, A> &other) noexcept : mem(other.mem) {}
+
+        T *allocate(const size_t n) {
+            if(n > SIZE_MAX / sizeof(T))
+                throw std::bad_array_new_length();
+
+            void *ptr = mem->mem_alloc_aligned(n * sizeof(T), alignof(T));
+            if(!ptr)
+                throw std::bad_alloc();
+
+            return (T*)ptr;
+        }
+
+        void deallocate(T *ptr, size_t) noexcept {
+            mem->mem_free(ptr);
+        }
+
+        inline A &heap() const { return *mem; }
+
+        template<typename U>
+        inline bool operator==(const MemStlAllocator<U, A> &other) const { return mem == other.mem; }
+
+        template<typename U>
+        inline bool operator!=(const MemStlAllocator<U, A> &other) const { return mem != other.mem; }
+};
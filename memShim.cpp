@@ -0,0 +1,239 @@
+// malloc & co on top of a THREADED heap, to run existing binaries on it without touching them:
+// g++ -std=c++17 -O2 -fPIC -shared -ftls-model=initial-exec -pthread memShim.cpp -o libmemshim.so -ldl
+// LD_PRELOAD=./libmemshim.so ./binary
+//
+// initial-exec keeps the thread cache of THREADED out of __tls_get_addr, which may call malloc itself.
+// everything the heap cant serve (full, too big, more threads than heaps) goes to the real libc,
+// and so does every pointer the heap doesnt own.
+
+#include "memAlloc.h"
+#include <dlfcn.h>
+#include <pthread.h>
+#include <errno.h>
+#include <new>
+
+namespace {
+
+    using Heap = MemAllocator<THREADED, 64ull*1024*1024*1024>;  // 64 heaps of 1GB, only reserved
+
+    // mallocs done while the heap itself is being built, never freed
+    constexpr   size_t      BOOTSTRAP_SIZE      = 64*1024;
+
+    alignas(Heap) char heapStorage[sizeof(Heap)];
+    Heap *heap = nullptr;
+    std::atomic<int> state { 0 }; // 0 nothing, 1 someone builds the heap, 2 ready
+
+    alignas(std::max_align_t) char bootstrap[BOOTSTRAP_SIZE];
+    std::atomic<size_t> bootstrapOffset { 0 };
+
+    thread_local bool building = false;
+
+    using MallocFn      = void *(*)(size_t);
+    using FreeFn        = void (*)(void*);
+    using ReallocFn     = void *(*)(void*, size_t);
+    using MemalignFn    = int (*)(void**, size_t, size_t);
+    using UsableFn      = size_t (*)(void*);
+
+    MallocFn realMalloc = nullptr;
+    FreeFn realFree = nullptr;
+    ReallocFn realRealloc = nullptr;
+    MemalignFn realMemalign = nullptr;
+    UsableFn realUsable = nullptr;
+
+    inline bool in_bootstrap(const void *ptr) {
+        return ptr >= bootstrap && ptr < bootstrap + BOOTSTRAP_SIZE;
+    }
+
+    void *bootstrap_alloc(const size_t size) {
+        const size_t aligned = (size + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        const size_t off = bootstrapOffset.fetch_add(aligned);
+
+        return (off + aligned <= BOOTSTRAP_SIZE ? bootstrap + off : nullptr);
+    }
+
+    // dlsym may allocate, by then the heap is ready and serves it
+    void resolve_libc() {
+        if(realMalloc)
+            return;
+
+        realFree = (FreeFn)dlsym(RTLD_NEXT, "free");
+        realRealloc = (ReallocFn)dlsym(RTLD_NEXT, "realloc");
+        realMemalign = (MemalignFn)dlsym(RTLD_NEXT, "posix_memalign");
+        realUsable = (UsableFn)dlsym(RTLD_NEXT, "malloc_usable_size");
+        realMalloc = (MallocFn)dlsym(RTLD_NEXT, "malloc");
+    }
+
+    // nullptr while this very thread is still building the heap
+    Heap *get_heap() {
+        if(state.load(std::memory_order_acquire) == 2)
+            return heap;
+
+        if(building)
+            return nullptr;
+
+        int expected = 0;
+        if(state.compare_exchange_strong(expected, 1, std::memory_order_acquire)) {
+            building = true;
+            heap = new(heapStorage) Heap();
+            building = false;
+
+            state.store(2, std::memory_order_release);
+            return heap;
+        }
+
+        while(state.load(std::memory_order_acquire) != 2)
+            std::this_thread::yield();
+
+        return heap;
+    }
+
+    void *alloc(const size_t size, const size_t alignment) {
+        Heap *h = get_heap();
+        if(!h)
+            return bootstrap_alloc(size);
+
+        void *ptr = h->mem_alloc_aligned(size, alignment);
+        if(ptr)
+            return ptr;
+
+        resolve_libc();
+
+        if(alignment <= alignof(std::max_align_t))
+            return realMalloc(size);
+
+        return (realMemalign(&ptr, alignment, size) ? nullptr : ptr);
+    }
+
+    size_t usable_size(void *ptr) {
+        if(!ptr)
+            return 0;
+
+        if(in_bootstrap(ptr))
+            return 0; // unknown, only realloc asks and copies what fits
+
+        Heap *h = get_heap();
+        if(h) {
+            if(const size_t size = h->mem_usable_size(ptr))
+                return size;
+        }
+
+        resolve_libc();
+        return realUsable(ptr);
+    }
+}
+
+extern "C" {
+
+    void *malloc(size_t size) {
+        void *ptr = alloc(size, alignof(std::max_align_t));
+        if(!ptr)
+            errno = ENOMEM;
+
+        return ptr;
+    }
+
+    void free(void *ptr) {
+        if(!ptr || in_bootstrap(ptr))
+            return;
+
+        Heap *h = get_heap();
+        if(h && h->mem_free(ptr))
+            return;
+
+        resolve_libc();
+        realFree(ptr);
+    }
+
+    void *calloc(size_t n, size_t size) {
+        if(size && n > SIZE_MAX / size) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        void *ptr = malloc(n * size);
+        if(ptr)
+            memset(ptr, 0, n * size);
+
+        return ptr;
+    }
+
+    // heap blocks take the heaps own realloc: shrinking gives the tail back, growing tries in place or mremap first
+    void *realloc(void *ptr, size_t size) {
+        if(!ptr)
+            return malloc(size);
+
+        if(size == 0) {
+            free(ptr);
+            return nullptr;
+        }
+
+        // bootstrap blocks dont know their size, copy what the buffer still holds
+        if(in_bootstrap(ptr)) {
+            void *x = malloc(size);
+            if(x) {
+                const size_t copy = bootstrap + BOOTSTRAP_SIZE - (char*)ptr;
+                memcpy(x, ptr, (copy < size ? copy : size));
+            }
+
+            return x;
+        }
+
+        Heap *h = get_heap();
+        const size_t old = (h ? h->mem_usable_size(ptr) : 0);
+
+        // libc block, libc moves it
+        if(!old) {
+            resolve_libc();
+            return realRealloc(ptr, size);
+        }
+
+        if(void *x = h->mem_realloc(ptr, size))
+            return x;
+
+        // the heap is full, the block moves to libc. ptr is still intact after a failed mem_realloc
+        resolve_libc();
+        void *x = realMalloc(size);
+        if(!x) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+
+        memcpy(x, ptr, (old < size ? old : size));
+        h->mem_free(ptr);
+
+        return x;
+    }
+
+    int posix_memalign(void **out, size_t alignment, size_t size) {
+        if(alignment < sizeof(void*) || (alignment & (alignment - 1)))
+            return EINVAL;
+
+        void *ptr = alloc(size, alignment);
+        if(!ptr)
+            return ENOMEM;
+
+        *out = ptr;
+        return 0;
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) {
+        if(!alignment || (alignment & (alignment - 1))) {
+            errno = EINVAL;
+            return nullptr;
+        }
+
+        void *ptr = alloc(size, alignment);
+        if(!ptr)
+            errno = ENOMEM;
+
+        return ptr;
+    }
+
+    void *memalign(size_t alignment, size_t size) {
+        return aligned_alloc(alignment, size);
+    }
+
+    size_t malloc_usable_size(void *ptr) {
+        return usable_size(ptr);
+    }
+}
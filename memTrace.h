@@ -0,0 +1,394 @@
+#pragma once
+
+#include "memAlloc.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <utility>
+
+
+// allocation traces, recorded from a running heap and replayed against any other (see replay.cpp).
+// the file is the magic followed by one record per call, every field a LEB128 varint:
+//      op, ns since the previous record, then
+//      ALLOC:      size, id
+//      FREE:       id
+//      REALLOC:    size, id, new id
+// the id of an object is the address it had while recording, so a freed address may come back as a new object.
+
+enum TraceOp : uint8_t { TRACE_ALLOC, TRACE_FREE, TRACE_REALLOC };
+
+static constexpr    char        TRACE_MAGIC[4]      = { 'M', 'T', 'R', '1' };
+
+// fills one buffer while a background thread writes the other one out,
+// so the recording thread only ever blocks if the disk is slower than the heap
+class TraceWriter {
+
+    private:
+        static constexpr    size_t      BUFFER_SIZE             = 64*1024,
+                                        MAX_RECORD              = 1 + 4 * 10;   // op + 4 varints of at most 10 bytes
+
+        FILE *file;
+        char buffers[2][BUFFER_SIZE];
+        char *cur = buffers[0];
+        size_t pos = 0;
+
+        // buffer handed to the writer thread, nullptr while it has nothing to do
+        char *pending = nullptr;
+        size_t pendingSize = 0;
+        bool stop = false;
+
+        std::mutex m;
+        std::condition_variable cv;
+        std::thread writer;
+
+        std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+        inline void put(uint64_t x) {
+            while(x >= 0x80) {
+                cur[pos++] = (char)(x | 0x80);
+                x >>= 7;
+            }
+
+            cur[pos++] = (char)x;
+        }
+
+        void write_loop() {
+            std::unique_lock<std::mutex> l(m);
+
+            for(;;) {
+                cv.wait(l, [this]() { return pending || stop; });
+
+                if(pending) {
+                    fwrite(pending, 1, pendingSize, file);
+                    pending = nullptr;
+                    cv.notify_all();
+                    continue;
+                }
+
+                return;
+            }
+        }
+
+        // hand the full buffer over and go on with the other one
+        void swap_buffers() {
+            std::unique_lock<std::mutex> l(m);
+            cv.wait(l, [this]() { return !pending; });
+
+            pending = cur;
+            pendingSize = pos;
+            cur = (cur == buffers[0] ? buffers[1] : buffers[0]);
+            pos = 0;
+
+            cv.notify_all();
+        }
+
+    public:
+
+        TraceWriter(FILE *file) : file(file) {
+            fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+            writer = std::thread(&TraceWriter::write_loop, this);
+        }
+
+        ~TraceWriter() {
+            swap_buffers();
+
+            {
+                std::unique_lock<std::mutex> l(m);
+                cv.wait(l, [this]() { return !pending; });
+                stop = true;
+                cv.notify_all();
+            }
+
+            writer.join();
+            fflush(file);
+        }
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter &operator=(const TraceWriter&) = delete;
+
+        void record(const TraceOp op, const size_t size, const void *id, const void *newId = nullptr) {
+            const auto now = std::chrono::steady_clock::now();
+            const uint64_t delta = std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+            last = now;
+
+            cur[pos++] = op;
+            put(delta);
+
+            if(op != TRACE_FREE)
+                put(size);
+
+            put((uintptr_t)id);
+
+            if(op == TRACE_REALLOC)
+                put((uintptr_t)newId);
+
+            if(pos > BUFFER_SIZE - MAX_RECORD)
+                swap_buffers();
+        }
+};
+
+// heaps that take calls from several threads at once, their tracer has to serialize
+template<typename A> struct SharedByThreads : std::false_type {};
+template<size_t M, size_t AL, typename S, typename H> struct SharedByThreads<MemAllocator<THREADED, M, AL, S, H>> : std::true_type {};
+template<size_t M, size_t AL, typename S, typename H> struct SharedByThreads<MemAllocator<CONCURRENT, M, AL, S, H>> : std::true_type {};
+template<size_t M, size_t AL, typename S, typename H> struct SharedByThreads<MemAllocator<SHARED, M, AL, S, H>> : std::true_type {};
+
+// records every call on a heap, the heap has to outlive the tracer.
+// failed calls are left out, they didnt change the heap.
+// on a heap several threads use the heap call and its record happen under one lock, so records never tear
+// and a free always lands before the alloc that gets its address back. that serializes the heap while tracing
+template<typename A>
+class MemTracer {
+
+    private:
+        static constexpr    bool    LOCKED      = SharedByThreads<A>::value;
+
+        A &mem;
+        TraceWriter writer;
+        std::mutex lock;
+
+        inline std::unique_lock<std::mutex> serialize() {
+            return (LOCKED ? std::unique_lock<std::mutex>(lock) : std::unique_lock<std::mutex>());
+        }
+
+        bool free_and_record(void *ptr) {
+            if(!mem.mem_free(ptr))
+                return false;
+
+            writer.record(TRACE_FREE, 0, ptr);
+            return true;
+        }
+
+    public:
+
+        MemTracer(A &mem, FILE *file) : mem(mem), writer(file) {}
+
+        inline A &heap() const { return mem; }
+
+        void *mem_alloc(const size_t size) {
+            auto l = serialize();
+
+            void *ptr = mem.mem_alloc(size);
+            if(ptr)
+                writer.record(TRACE_ALLOC, size, ptr);
+
+            return ptr;
+        }
+
+        bool mem_free(void *ptr) {
+            auto l = serialize();
+            return free_and_record(ptr);
+        }
+
+        void *mem_realloc(void *ptr, const size_t size) {
+            auto l = serialize();
+
+            // to size 0 its a free, like the heaps do it. only recorded if the heap owned ptr
+            if(ptr && size == 0) {
+                free_and_record(ptr);
+                return nullptr;
+            }
+
+            void *x = mem.mem_realloc(ptr, size);
+
+            // realloc of nullptr is an alloc
+            if(!ptr && x)
+                writer.record(TRACE_ALLOC, size, x);
+            else if(x)
+                writer.record(TRACE_REALLOC, size, ptr, x);
+
+            return x;
+        }
+};
+
+// reads a trace back record by record
+class TraceReader {
+
+    private:
+        FILE *file;
+
+        bool get(uint64_t &x) {
+            x = 0;
+
+            for(int shift = 0; shift < 64; shift += 7) {
+                const int c = fgetc(file);
+                if(c == EOF)
+                    return false;
+
+                x |= (uint64_t)(c & 0x7f) << shift;
+                if(!(c & 0x80))
+                    return true;
+            }
+
+            return false;
+        }
+
+    public:
+
+        struct Record {
+            TraceOp op;
+            uint64_t delta, size, id, newId;
+        };
+
+        // false if the file isnt a trace
+        bool valid = false;
+
+        TraceReader(FILE *file) : file(file) {
+            char magic[sizeof(TRACE_MAGIC)];
+            valid = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && !memcmp(magic, TRACE_MAGIC, sizeof(magic));
+        }
+
+        // false at the end of the trace or on a broken record
+        bool next(Record &r) {
+            const int op = fgetc(file);
+            if(op == EOF || op > TRACE_REALLOC)
+                return false;
+
+            r = { (TraceOp)op, 0, 0, 0, 0 };
+
+            if(!get(r.delta))
+                return false;
+
+            if(r.op != TRACE_FREE && !get(r.size))
+                return false;
+
+            if(!get(r.id))
+                return false;
+
+            return r.op != TRACE_REALLOC || get(r.newId);
+        }
+};
+
+// what a replay found, memory is sampled after every call
+struct ReplayStats {
+    size_t      ops             = 0,
+                failed          = 0,    // allocs the heap couldnt serve
+                peakUsed        = 0,    // highest mem_used()
+                liveAtPeak      = 0,    // bytes the trace had live right then
+                peakLive        = 0;
+    double      seconds         = 0;    // whole replay, from the run without sampling
+
+    // share of the heap at its peak that wasnt live data, headers, padding and free blocks
+    inline double fragmentation() const { return (peakUsed ? 1.0 - (double)liveAtPeak / peakUsed : 0); }
+};
+
+// runs a trace against a heap, once timed and once sampling mem_used() after every call.
+// heaps without mem_realloc get alloc + copy + free instead
+template<typename A>
+class TraceReplay {
+
+    private:
+        struct Live {
+            void *ptr;
+            size_t size;
+        };
+
+        template<typename H>
+        static auto realloc_of(H &mem, void *ptr, size_t, const size_t size, int) -> decltype(mem.mem_realloc(ptr, size)) {
+            return mem.mem_realloc(ptr, size);
+        }
+
+        template<typename H>
+        static void *realloc_of(H &mem, void *ptr, const size_t oldSize, const size_t size, long) {
+            void *x = mem.mem_alloc(size);
+            if(x) {
+                memcpy(x, ptr, (oldSize < size ? oldSize : size));
+                mem.mem_free(ptr);
+            }
+
+            return x;
+        }
+
+        static bool pass(FILE *file, ReplayStats &stats, const bool sample) {
+            rewind(file);
+
+            TraceReader reader(file);
+            if(!reader.valid)
+                return false;
+
+            A *mem = new A();
+            std::unordered_map<uint64_t, Live> live;
+            size_t liveBytes = 0;
+            TraceReader::Record r;
+
+            const auto start = std::chrono::steady_clock::now();
+
+            while(reader.next(r)) {
+                stats.ops++;
+
+                if(r.op == TRACE_ALLOC) {
+                    void *x = mem->mem_alloc(r.size);
+
+                    if(x) {
+                        live[r.id] = { x, r.size };
+                        liveBytes += r.size;
+                    }
+                    else
+                        stats.failed++;
+                }
+                else {
+                    auto it = live.find(r.id);
+                    if(it == live.end())
+                        continue;
+
+                    const Live l = it->second;
+                    live.erase(it);
+                    liveBytes -= l.size;
+
+                    if(r.op == TRACE_FREE)
+                        mem->mem_free(l.ptr);
+                    else if(void *x = realloc_of(*mem, l.ptr, l.size, r.size, 0)) {
+                        live[r.newId] = { x, r.size };
+                        liveBytes += r.size;
+                    }
+                    else {
+                        live[r.id] = l; // a failed realloc leaves the block as it was
+                        liveBytes += l.size;
+                        stats.failed++;
+                    }
+                }
+
+                if(sample) {
+                    const size_t used = mem->mem_used();
+
+                    if(used > stats.peakUsed) {
+                        stats.peakUsed = used;
+                        stats.liveAtPeak = liveBytes;
+                    }
+
+                    if(liveBytes > stats.peakLive)
+                        stats.peakLive = liveBytes;
+                }
+            }
+
+            if(!sample)
+                stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            for(auto &[id, l] : live)
+                mem->mem_free(l.ptr);
+
+            delete mem;
+            return true;
+        }
+
+    public:
+
+        // false if the file isnt a trace
+        static bool run(FILE *file, ReplayStats &stats) {
+            stats = ReplayStats();
+            if(!pass(file, stats, false))
+                return false;
+
+            const double seconds = stats.seconds;
+            stats = ReplayStats();
+            pass(file, stats, true);
+            stats.seconds = seconds;
+
+            return true;
+        }
+};
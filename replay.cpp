@@ -0,0 +1,73 @@
+#include <iostream>
+#include <malloc.h>
+#include <cstdlib>
+#include <cstring>
+#include "memTrace.h"
+
+using namespace std;
+
+// replays a trace recorded with MemTracer against the heaps and glibc malloc
+// g++ -std=c++17 -O2 -pthread replay.cpp -o replay && ./replay trace.bin [FAST|PRECISE|TLSF|SLAB|malloc]
+
+static constexpr size_t MEM_SIZE = 1024ull*1024*1024;
+
+struct Malloc {
+    inline void *mem_alloc(const size_t size)                   { return malloc(size); }
+    inline bool mem_free(void *ptr)                             { free(ptr); return true; }
+    inline void *mem_realloc(void *ptr, const size_t size)      { return realloc(ptr, size); }
+
+    size_t calls = 0,
+           used = 0;
+
+    // what glibc took from the kernel, free chunks included.
+    // mallinfo2 walks every bin, so it only gets asked every 256th call
+    inline size_t mem_used() {
+        if(calls++ % 256 == 0) {
+            const struct mallinfo2 mi = mallinfo2();
+            used = mi.arena + mi.hblkhd;
+        }
+
+        return used;
+    }
+};
+
+template<typename A>
+void replay(FILE *file, const char *name, const char *only) {
+    if(only && strcmp(only, name))
+        return;
+
+    ReplayStats stats;
+    if(!TraceReplay<A>::run(file, stats)) {
+        cerr << "not a trace" << endl;
+        exit(1);
+    }
+
+    printf("%-8s %10zu %10.2f %12.2f %12.2f %8.1f%% %8zu\n", name, stats.ops, stats.seconds * 1e3,
+           stats.peakUsed / (1024.0 * 1024.0), stats.peakLive / (1024.0 * 1024.0), stats.fragmentation() * 100, stats.failed);
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        cerr << "usage: " << argv[0] << " trace.bin [FAST|PRECISE|TLSF|SLAB|malloc]" << endl;
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if(!file) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    const char *only = (argc > 2 ? argv[2] : nullptr);
+
+    printf("%-8s %10s %10s %12s %12s %9s %8s\n", "", "ops", "ms", "peak used MB", "peak live MB", "frag", "failed");
+
+    replay<MemAllocator<FAST, MEM_SIZE>>(file, "FAST", only);
+    replay<MemAllocator<PRECISE, MEM_SIZE>>(file, "PRECISE", only);
+    replay<MemAllocator<TLSF, MEM_SIZE>>(file, "TLSF", only);
+    replay<MemAllocator<SLAB, MEM_SIZE>>(file, "SLAB", only);
+    replay<Malloc>(file, "malloc", only);
+
+    fclose(file);
+    return 0;
+}